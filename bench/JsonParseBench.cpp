@@ -0,0 +1,70 @@
+// Times the library item parse paths on a synthetic stream of item objects:
+// Qt's parser, simdjson converted to QJson, and simdjson read directly.
+//
+//   elixir-json-bench [items] [rounds]
+
+#include "backend/JsonBackend.h"
+#include "backend/MediaItemParser.h"
+#include "SyntheticLibrary.h"
+
+#include <QByteArrayList>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+// Best of rounds, in milliseconds.
+double bestOf(int rounds, const std::function<int()> &run, int *parsed) {
+    double best = 0.0;
+    for (int round = 0; round < rounds; ++round) {
+        QElapsedTimer timer;
+        timer.start();
+        *parsed = run();
+        const double elapsed = timer.nsecsElapsed() / 1e6;
+        best = round == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    const QString baseUrl = QStringLiteral("http://localhost:44301");
+    const QByteArrayList items = SyntheticLibrary::items(count);
+    QTextStream out(stdout);
+    out << "items " << count << " rounds " << rounds << " backend " << JsonBackend::name() << Qt::endl;
+
+    int parsed = 0;
+    const double qt = bestOf(rounds, [&]() {
+        int valid = 0;
+        for (const QByteArray &json : items) {
+            valid += !MediaItemParser::fromJson(QJsonDocument::fromJson(json).object(), baseUrl).id.isEmpty();
+        }
+        return valid;
+    }, &parsed);
+    out << "qt json -> item          " << qt << " ms (" << parsed << " items)" << Qt::endl;
+
+    const double converted = bestOf(rounds, [&]() {
+        int valid = 0;
+        for (const QByteArray &json : items) {
+            valid += !MediaItemParser::fromJson(JsonBackend::parse(json).object(), baseUrl).id.isEmpty();
+        }
+        return valid;
+    }, &parsed);
+    out << "backend -> qjson -> item " << converted << " ms (" << parsed << " items)" << Qt::endl;
+
+    const double direct = bestOf(rounds, [&]() {
+        int valid = 0;
+        for (const QByteArray &json : items) {
+            bool ok = false;
+            valid += !MediaItemParser::fromJson(json, baseUrl, &ok).id.isEmpty() && ok;
+        }
+        return valid;
+    }, &parsed);
+    out << "backend -> item          " << direct << " ms (" << parsed << " items)" << Qt::endl;
+    return 0;
+}
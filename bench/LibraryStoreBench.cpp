@@ -0,0 +1,61 @@
+// Measures the memory held by a synthetic library in LibraryStore and in the
+// QVector<MediaItem> layout it replaced: resident set growth where the
+// platform reports it, and each layout's own byte estimate.
+//
+//   elixir-store-bench [items]      defaults to 100000
+
+#include "backend/LibraryStore.h"
+#include "backend/MediaItemParser.h"
+#include "SyntheticLibrary.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+// Resident bytes of this process, or 0 where that is not available.
+qint64 residentBytes() {
+#ifdef Q_OS_LINUX
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return 0;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100000;
+    QTextStream out(stdout);
+
+    // Items are parsed one at a time so only the layout being measured
+    // stays resident.
+    const qint64 before = residentBytes();
+    LibraryStore store;
+    for (int i = 0; i < count; ++i) {
+        store.append(MediaItemParser::fromJson(SyntheticLibrary::itemJson(i), QString()));
+    }
+    const qint64 compact = residentBytes();
+
+    QVector<MediaItem> items;
+    for (int i = 0; i < count; ++i) {
+        items.append(MediaItemParser::fromJson(SyntheticLibrary::itemJson(i), QString()));
+    }
+    const qint64 expanded = residentBytes();
+
+    out << "items " << count << Qt::endl;
+    out << "  column store    rss +" << (compact - before) / 1024 << " KiB, estimate "
+        << store.bytesUsed() / count << " bytes per item" << Qt::endl;
+    out << "  MediaItem array rss +" << (expanded - compact) / 1024 << " KiB, estimate "
+        << LibraryStore::bytesUsed(items) / count << " bytes per item" << Qt::endl;
+    return 0;
+}
@@ -0,0 +1,139 @@
+// Compares LibraryModel's single-pass view engine with the six
+// QSortFilterProxyModel views it replaced, on a synthetic library:
+//
+//  - streaming the library in, with and without the proxies attached
+//    (the proxies re-filter and sort-insert every batch),
+//  - switching the sort mode, which re-derives every view.
+//
+//   elixir-views-bench [items...]      defaults to 10000 100000
+
+#include "backend/LibraryModel.h"
+#include "SyntheticLibrary.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QSortFilterProxyModel>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr int kBatchSize = 500;
+
+// The proxy the view engine replaced, kept here as the baseline.
+class ReferenceFilterModel : public QSortFilterProxyModel {
+public:
+    ReferenceFilterModel(const QString &typeFilter, bool requireProgress)
+        : m_typeFilter(typeFilter),
+          m_requireProgress(requireProgress) {
+        setDynamicSortFilter(true);
+        setSortCaseSensitivity(Qt::CaseInsensitive);
+        setSortLocaleAware(true);
+    }
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override {
+        const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+        if (!m_typeFilter.isEmpty() && sourceModel()->data(index, MediaRoles::TypeRole).toString() != m_typeFilter) {
+            return false;
+        }
+        if (m_requireProgress && sourceModel()->data(index, MediaRoles::ProgressRole).toDouble() <= 0.0) {
+            return false;
+        }
+        return true;
+    }
+
+private:
+    QString m_typeFilter;
+    bool m_requireProgress = false;
+};
+
+struct ReferenceViews {
+    explicit ReferenceViews(LibraryModel *source) {
+        const std::pair<QString, bool> filters[] = {
+            {QString(), false}, {"movie", false}, {"series", false}, {"anime", false}, {QString(), true}, {QString(), false},
+        };
+        for (const auto &filter : filters) {
+            models.push_back(std::make_unique<ReferenceFilterModel>(filter.first, filter.second));
+            models.back()->setSourceModel(source);
+        }
+        sort(MediaRoles::UpdatedAtRole, Qt::DescendingOrder);
+    }
+
+    void sort(int role, Qt::SortOrder order) {
+        for (const auto &model : models) {
+            model->setSortRole(role);
+            model->sort(0, order);
+        }
+    }
+
+    std::vector<std::unique_ptr<ReferenceFilterModel>> models;
+};
+
+double streamInto(LibraryModel *model, const QByteArrayList &items) {
+    QEventLoop loop;
+    // A fresh model publishes its sync cursor once the stream has finished.
+    QObject::connect(model, &LibraryModel::syncCursorChanged, &loop, &QEventLoop::quit);
+    QElapsedTimer timer;
+    timer.start();
+    model->beginLibraryStream();
+    for (qsizetype offset = 0; offset < items.size(); offset += kBatchSize) {
+        model->appendLibraryItems(items.mid(offset, kBatchSize));
+    }
+    model->finishLibraryStream();
+    loop.exec();
+    return timer.nsecsElapsed() / 1e6;
+}
+
+template <typename Function>
+double timed(Function function) {
+    QElapsedTimer timer;
+    timer.start();
+    function();
+    return timer.nsecsElapsed() / 1e6;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+    // Keeps the library snapshot written after each stream out of the user's data.
+    QStandardPaths::setTestModeEnabled(true);
+
+    QVector<int> counts;
+    for (int i = 1; i < argc; ++i) {
+        counts.append(std::atoi(argv[i]));
+    }
+    if (counts.isEmpty()) {
+        counts = {10000, 100000};
+    }
+
+    QTextStream out(stdout);
+    for (const int count : std::as_const(counts)) {
+        const QByteArrayList items = SyntheticLibrary::items(count);
+        out << "items " << count << Qt::endl;
+
+        LibraryModel engine;
+        out << "  stream, view engine          " << streamInto(&engine, items) << " ms" << Qt::endl;
+
+        LibraryModel proxied;
+        ReferenceViews proxies(&proxied);
+        out << "  stream, engine + six proxies " << streamInto(&proxied, items) << " ms" << Qt::endl;
+
+        const std::pair<const char *, std::pair<int, Qt::SortOrder>> modes[] = {
+            {"title", {MediaRoles::TitleRole, Qt::AscendingOrder}},
+            {"year", {MediaRoles::YearRole, Qt::DescendingOrder}},
+            {"recent", {MediaRoles::UpdatedAtRole, Qt::DescendingOrder}},
+        };
+        for (const auto &mode : modes) {
+            const double viewEngine = timed([&]() { engine.setSortMode(mode.first); });
+            const double reference = timed([&]() { proxies.sort(mode.second.first, mode.second.second); });
+            out << "  sort " << mode.first << ": view engine " << viewEngine << " ms, six proxies " << reference
+                << " ms" << Qt::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Times SearchIndex on a synthetic library: building the index, then
+// rankedSearch and the exact prefix search for every keystroke of a few
+// queries, including misspelled ones.
+//
+//   elixir-search-bench [items] [rounds]      defaults to 100000 5
+
+#include "backend/MediaItemParser.h"
+#include "backend/SearchIndex.h"
+#include "SyntheticLibrary.h"
+
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+constexpr int kRankedLimit = 200;
+} // namespace
+
+int main(int argc, char **argv) {
+    const int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int rounds = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+    QTextStream out(stdout);
+
+    QVector<MediaItem> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        items.append(MediaItemParser::fromJson(SyntheticLibrary::itemJson(i), QString()));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    SearchIndex index;
+    for (const MediaItem &item : std::as_const(items)) {
+        index.insert(item);
+    }
+    out << "items " << index.size() << " index built in " << timer.elapsed() << " ms" << Qt::endl;
+
+    const QStringList queries = {"spirited away", "spirted awya", "shadow gardn", "crimson harbor 42", "titan"};
+    for (const QString &query : queries) {
+        double worstRanked = 0.0;
+        double totalRanked = 0.0;
+        double worstExact = 0.0;
+        int keystrokes = 0;
+        int hits = 0;
+        for (qsizetype typed = 1; typed <= query.size(); ++typed) {
+            const QString prefix = query.left(typed);
+            if (prefix.endsWith(QLatin1Char(' '))) {
+                continue;
+            }
+            double ranked = 0.0;
+            double exact = 0.0;
+            for (int round = 0; round < rounds; ++round) {
+                timer.start();
+                hits = index.rankedSearch(prefix, kRankedLimit).size();
+                const double rankedMs = timer.nsecsElapsed() / 1e6;
+                timer.start();
+                index.search(prefix);
+                const double exactMs = timer.nsecsElapsed() / 1e6;
+                ranked = round == 0 ? rankedMs : std::min(ranked, rankedMs);
+                exact = round == 0 ? exactMs : std::min(exact, exactMs);
+            }
+            worstRanked = std::max(worstRanked, ranked);
+            totalRanked += ranked;
+            worstExact = std::max(worstExact, exact);
+            ++keystrokes;
+        }
+        out << '"' << query << "\" ranked mean " << totalRanked / keystrokes << " ms, worst " << worstRanked
+            << " ms; exact worst " << worstExact << " ms; " << hits << " ranked hits" << Qt::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayList>
+
+// Library item objects shaped like /api/v1/library/items entries, for the
+// benchmarks. Titles draw from a small vocabulary so search terms recur the
+// way real titles do; types, genres and progress follow a fixed mix.
+namespace SyntheticLibrary {
+    inline QByteArray itemJson(int i) {
+        static const char *const words[] = {
+            "shadow", "garden", "spirited", "away", "attack", "titan", "river", "night", "crimson", "harbor",
+            "silent", "empire", "winter", "station", "golden", "forest", "last", "kingdom", "paper", "moon",
+            "iron", "tide", "hidden", "valley", "broken", "crown", "distant", "signal", "glass", "city",
+        };
+        constexpr int wordCount = int(sizeof(words) / sizeof(words[0]));
+        static const char *const types[] = {"movie", "movie", "series", "anime"};
+        const QByteArray n = QByteArray::number(i);
+        const QByteArray title = QByteArray(words[i % wordCount]) + ' ' + words[(i / wordCount) % wordCount] + ' '
+            + words[(i / 7 + 3) % wordCount] + ' ' + n;
+        return "{\"id\":\"item-" + n + "\",\"title\":\"" + title + "\",\"type\":\"" + types[i % 4]
+            + "\",\"year\":" + QByteArray::number(1960 + i % 64)
+            + ",\"updated_at\":\"2024-05-" + QByteArray::number(10 + i % 18) + "T12:" + QByteArray::number(10 + i % 50)
+            + ":00.000Z\",\"created_at\":\"2023-01-01T00:00:00Z\",\"runtime_seconds\":"
+            + QByteArray::number(1800 + i % 5400) + ",\"progress\":" + QByteArray::number(i % 5 == 0 ? (i % 100) / 100.0 : 0.0)
+            + ",\"poster_url\":\"/images/posters/" + n + ".jpg\",\"backdrop_url\":\"/images/backdrops/" + n + ".jpg\""
+            + ",\"genres\":[\"Drama\",\"" + (i % 2 ? "Action" : "Comedy") + "\"],\"metadata\":{\"original_title\":\""
+            + title + " original\",\"synonyms\":[\"Alt " + n + "\"],\"overview\":\"A <b>synthetic</b> overview for item "
+            + n + " long enough to look like a real plot summary.\"}}";
+    }
+
+    inline QByteArrayList items(int count) {
+        QByteArrayList list;
+        list.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            list.append(itemJson(i));
+        }
+        return list;
+    }
+}
@@ -1,27 +1,83 @@
 #include "backend/ApiClient.h"
 
+#include "backend/HttpCore.h"
+#include "backend/JsonBackend.h"
+#include "backend/LibraryStreamParser.h"
+#include "backend/Logging.h"
+#include "backend/TraceRecorder.h"
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QNetworkReply>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QUrlQuery>
 #include <QDebug>
 #include <QLocale>
+#include <QtConcurrent/QtConcurrentRun>
+#include <utility>
+
+namespace {
+constexpr qsizetype kInlineParseBytes = 32 * 1024;
+constexpr int kDetailsCacheEntries = 256;
+constexpr qint64 kDetailsMaxAgeMs = 5 * 60 * 1000;
+constexpr qsizetype kDetailsBatchSize = 50;
+constexpr int kDetailsPrefetchDelayMs = 150;
+
+// The subject claim of a JWT access token, which stays the same across
+// refreshes. Opaque tokens have none.
+QString tokenSubject(const QString &token) {
+    const QStringList parts = token.split(QLatin1Char('.'));
+    if (parts.size() != 3) {
+        return QString();
+    }
+    const auto decoded = QByteArray::fromBase64Encoding(
+        parts.at(1).toLatin1(), QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    if (!decoded) {
+        return QString();
+    }
+    const QJsonObject claims = QJsonDocument::fromJson(*decoded).object();
+    const QJsonValue subject = claims.value("sub");
+    return subject.isDouble() ? QString::number(subject.toInteger()) : subject.toString();
+}
+} // namespace
 
-ApiClient::ApiClient(QObject *parent)
-    : QObject(parent) {}
+ApiClient::ApiClient(HttpCore *http, QObject *parent)
+    : QObject(parent),
+      m_http(http),
+      m_detailsCache(kDetailsCacheEntries) {
+    connect(m_http, &HttpCore::hostCapacityAvailable, this, &ApiClient::pumpQueues);
+    m_detailsPrefetchTimer.setSingleShot(true);
+    m_detailsPrefetchTimer.setInterval(kDetailsPrefetchDelayMs);
+    connect(&m_detailsPrefetchTimer, &QTimer::timeout, this, &ApiClient::flushDetailsPrefetch);
+    connect(this, &ApiClient::scanCompleted, this, &ApiClient::invalidateLibraryCaches);
+    connect(this, &ApiClient::reviewApplied, this, &ApiClient::invalidateLibraryCaches);
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheDir.isEmpty()) {
+        m_responseCache.setDirectory(cacheDir + "/api");
+        m_seriesCache.setDirectory(cacheDir + "/series");
+    }
+}
 
 QString ApiClient::baseUrl() const {
     return m_baseUrl;
 }
 
 void ApiClient::setBaseUrl(const QString &value) {
-    const QString normalized = normalizeBaseUrl(value);
+    const QString normalized = HttpCore::normalizeBaseUrl(value);
     if (m_baseUrl == normalized) {
         return;
     }
     m_baseUrl = normalized;
+    m_detailsCache.clear();
+    m_seriesCache.setScope(m_baseUrl + '\n' + m_accountId);
+    m_batchDetailsSupported = true;
     emit baseUrlChanged();
+    warmConnection();
 }
 
 QString ApiClient::authToken() const {
@@ -33,7 +89,24 @@ void ApiClient::setAuthToken(const QString &value) {
         return;
     }
     m_authToken = value;
+    QString accountId = tokenSubject(value);
+    if (accountId.isEmpty() && !value.isEmpty()) {
+        // Opaque tokens say nothing about the account, so each token is its own.
+        accountId = "token:"
+            + QString::fromLatin1(QCryptographicHash::hash(value.toUtf8(), QCryptographicHash::Sha1).toHex());
+    }
+    m_detailsCache.clear();
+    m_seriesCache.clear();
     emit authTokenChanged();
+    if (m_accountId != accountId) {
+        m_accountId = accountId;
+        m_seriesCache.setScope(m_baseUrl + '\n' + m_accountId);
+        emit accountIdChanged();
+    }
+}
+
+QString ApiClient::accountId() const {
+    return m_accountId;
 }
 
 QString ApiClient::accessTokenExpiresAt() const {
@@ -72,6 +145,10 @@ void ApiClient::setNetworkType(const QString &value) {
     emit networkTypeChanged();
 }
 
+int ApiClient::coalescedRequestCount() const {
+    return m_coalescedRequestCount;
+}
+
 void ApiClient::login(const QString &email, const QString &password) {
     QJsonObject body{{"email", email.trimmed()}, {"password", password}};
     sendRequest(
@@ -150,91 +227,362 @@ void ApiClient::completePasswordReset(const QString &token, const QString &newPa
 }
 
 void ApiClient::fetchLibrary() {
+    auto parser = std::make_shared<LibraryStreamParser>();
     sendRequest("GET", "/api/v1/library/items", QJsonObject(),
+                [this](const QJsonDocument &) { emit libraryReceived(); },
+                [this](const QString &) { emit libraryStreamAborted(); },
+                false,
+                [this, parser](const QByteArray &chunk, bool last) {
+                    const bool wasStarted = parser->started();
+                    const QByteArrayList items = parser->feed(chunk);
+                    if (!wasStarted && parser->started()) {
+                        emit libraryStreamStarted();
+                    }
+                    if (!items.isEmpty()) {
+                        emit libraryItemsReceived(items);
+                    }
+                    return !parser->hasError() && (!last || parser->finished());
+                });
+}
+
+void ApiClient::fetchLibraryChanges(const QString &since) {
+    if (since.trimmed().isEmpty()) {
+        fetchLibrary();
+        return;
+    }
+    QUrlQuery query;
+    query.addQueryItem("updated_since", since.trimmed());
+    query.addQueryItem("include_deleted", "true");
+    const QString path = QString("/api/v1/library/items?%1").arg(query.toString(QUrl::FullyEncoded));
+    sendRequest("GET", path, QJsonObject(),
                 [this](const QJsonDocument &doc) {
-                    if (!doc.isArray()) {
-                        emit requestFailed("/api/v1/library/items", "Library response was not a list.");
+                    QJsonArray items;
+                    QStringList removedIds;
+                    // A server that ignores the delta parameters answers with
+                    // the full list, which must replace the library so items
+                    // deleted on the server go away.
+                    if (doc.isArray()) {
+                        emit libraryReplaced(doc.array());
+                        return;
+                    } else if (doc.isObject()) {
+                        const QJsonObject obj = doc.object();
+                        items = obj.value("items").toArray();
+                        if (!obj.contains("deleted_ids") && !obj.contains("deleted")) {
+                            emit libraryReplaced(items);
+                            return;
+                        }
+                        QJsonArray deleted = obj.value("deleted_ids").toArray();
+                        if (deleted.isEmpty()) {
+                            deleted = obj.value("deleted").toArray();
+                        }
+                        for (const QJsonValue &value : deleted) {
+                            const QString id = value.isObject()
+                                ? value.toObject().value("id").toString()
+                                : value.toString();
+                            if (!id.isEmpty()) {
+                                removedIds.append(id);
+                            }
+                        }
+                    } else {
+                        emit requestFailed("/api/v1/library/items", "Library delta response was not a list.");
                         return;
                     }
-                    emit libraryReceived(doc.array().toVariantList());
+                    emit libraryDeltaReceived(items, removedIds);
                 });
 }
 
-void ApiClient::fetchMediaDetails(const QString &mediaItemId) {
-    sendRequest("GET", QString("/api/v1/library/items/%1").arg(mediaItemId), QJsonObject(),
+void ApiClient::syncLibrary(const QString &since) {
+    if (since.trimmed().isEmpty()) {
+        fetchLibrary();
+    } else {
+        fetchLibraryChanges(since);
+    }
+}
+
+int ApiClient::fetchMediaDetails(const QString &mediaItemId) {
+    const int requestId = sendRequest("GET", QString("/api/v1/library/items/%1").arg(mediaItemId), QJsonObject(),
                 [this](const QJsonDocument &doc) {
                     if (!doc.isObject()) {
                         emit requestFailed("/api/v1/library/items/:id", "Details response was not an object.");
                         return;
                     }
-                    QVariantMap details = doc.object().toVariantMap();
-                    const QVariant existingGenres = details.value("genres");
-                    if (existingGenres.toList().isEmpty()) {
-                        QVariantList parsed;
-                        const QVariantMap meta = details.value("metadata").toMap();
-                        const QVariant metaGenres = meta.value("genres");
-                        if (metaGenres.canConvert<QVariantList>()) {
-                            parsed = metaGenres.toList();
-                        } else if (metaGenres.canConvert<QStringList>()) {
-                            const QStringList list = metaGenres.toStringList();
-                            for (const QString &value : list) {
-                                parsed.append(value);
+                    const QVariantMap details = normalizeDetails(doc.object());
+                    cacheMediaDetails(details);
+                    emit mediaDetailsReceived(details);
+                });
+    return supersede("details", requestId);
+}
+
+int ApiClient::refreshMediaDetails(const QString &mediaItemId) {
+    const int requestId = warmRequest(QString("/api/v1/library/items/%1").arg(mediaItemId),
+                [this, mediaItemId](const QJsonDocument &doc) {
+                    if (!doc.isObject()) {
+                        return;
+                    }
+                    const QVariantMap previous = cachedMediaDetails(mediaItemId);
+                    const QVariantMap details = normalizeDetails(doc.object());
+                    cacheMediaDetails(details);
+                    if (details != previous) {
+                        emit mediaDetailsReceived(details);
+                    }
+                });
+    return supersede("details", requestId);
+}
+
+void ApiClient::prefetchMediaDetails(const QStringList &mediaItemIds) {
+    for (const QString &id : mediaItemIds) {
+        const QString trimmed = id.trimmed();
+        if (trimmed.isEmpty() || m_detailsPrefetching.contains(trimmed) || !cachedMediaDetails(trimmed).isEmpty()) {
+            continue;
+        }
+        m_detailsPrefetching.insert(trimmed);
+        m_detailsPrefetchQueue.append(trimmed);
+    }
+    // Cards are created one by one while a row fills; gather them into one batch.
+    if (!m_detailsPrefetchQueue.isEmpty() && !m_detailsPrefetchTimer.isActive()) {
+        m_detailsPrefetchTimer.start();
+    }
+}
+
+QVariantMap ApiClient::cachedMediaDetails(const QString &mediaItemId) {
+    const CachedDetails *cached = m_detailsCache.object(mediaItemId);
+    if (!cached) {
+        return QVariantMap();
+    }
+    if (cached->age.elapsed() > kDetailsMaxAgeMs) {
+        m_detailsCache.remove(mediaItemId);
+        return QVariantMap();
+    }
+    return cached->details;
+}
+
+void ApiClient::flushDetailsPrefetch() {
+    const QStringList ids = std::exchange(m_detailsPrefetchQueue, QStringList());
+    if (m_baseUrl.isEmpty()) {
+        for (const QString &id : ids) {
+            m_detailsPrefetching.remove(id);
+        }
+        return;
+    }
+    if (!m_batchDetailsSupported) {
+        prefetchDetailsIndividually(ids);
+        return;
+    }
+
+    for (qsizetype offset = 0; offset < ids.size(); offset += kDetailsBatchSize) {
+        const QStringList chunk = ids.mid(offset, kDetailsBatchSize);
+        sendRequest("POST", "/api/v1/library/items/batch", QJsonObject{{"ids", QJsonArray::fromStringList(chunk)}},
+                    [this, chunk](const QJsonDocument &doc) {
+                        const QJsonArray items = doc.isArray() ? doc.array() : doc.object().value("items").toArray();
+                        for (const QJsonValue &value : items) {
+                            if (value.isObject()) {
+                                cacheMediaDetails(normalizeDetails(value.toObject()));
                             }
                         }
-                        if (parsed.isEmpty()) {
-                            const QString single = meta.value("genre").toString();
-                            if (!single.trimmed().isEmpty()) {
-                                parsed.append(single);
-                            }
+                        for (const QString &id : chunk) {
+                            m_detailsPrefetching.remove(id);
                         }
-                        if (!parsed.isEmpty()) {
-                            details.insert("genres", parsed);
+                    },
+                    [this, chunk](const QString &error) {
+                        // Servers without the batch endpoint get one GET per
+                        // item from then on; other failures are not about the
+                        // endpoint, so only this batch is dropped.
+                        const int status = m_failureStatus;
+                        if (status == 404 || status == 405 || status == 501) {
+                            qCInfo(lcApi) << "Batch details unavailable, falling back" << status << error;
+                            m_batchDetailsSupported = false;
+                            prefetchDetailsIndividually(chunk);
+                            return;
                         }
-                    }
-                    emit mediaDetailsReceived(details);
-                });
+                        for (const QString &id : chunk) {
+                            m_detailsPrefetching.remove(id);
+                        }
+                    },
+                    false,
+                    ChunkHandler(),
+                    true);
+    }
+}
+
+void ApiClient::prefetchDetailsIndividually(const QStringList &mediaItemIds) {
+    for (const QString &id : mediaItemIds) {
+        warmRequest(QString("/api/v1/library/items/%1").arg(id),
+                    [this, id](const QJsonDocument &doc) {
+                        m_detailsPrefetching.remove(id);
+                        if (doc.isObject()) {
+                            cacheMediaDetails(normalizeDetails(doc.object()));
+                        }
+                    },
+                    [this, id](const QString &) { m_detailsPrefetching.remove(id); });
+    }
+}
+
+int ApiClient::warmMediaDetails(const QString &mediaItemId) {
+    if (mediaItemId.trimmed().isEmpty() || !cachedMediaDetails(mediaItemId).isEmpty()) {
+        return 0;
+    }
+    return warmRequest(QString("/api/v1/library/items/%1").arg(mediaItemId), [this](const QJsonDocument &doc) {
+        if (doc.isObject()) {
+            cacheMediaDetails(normalizeDetails(doc.object()));
+        }
+    });
 }
 
-void ApiClient::fetchSeasons(const QString &seriesId) {
+int ApiClient::warmSeasons(const QString &seriesId, const std::function<void(const QVariantList &)> &onSeasons) {
     if (seriesId.trimmed().isEmpty()) {
+        return 0;
+    }
+    QJsonDocument cached;
+    if (m_seriesCache.lookup("seasons/" + seriesId, &cached)) {
+        if (onSeasons) {
+            onSeasons(cached.array().toVariantList());
+        }
+        return 0;
+    }
+    return warmRequest(QString("/api/v1/library/series/%1/seasons").arg(seriesId), [this, seriesId, onSeasons](const QJsonDocument &doc) {
+        if (!doc.isArray()) {
+            return;
+        }
+        m_seriesCache.insert("seasons/" + seriesId, doc);
+        if (onSeasons) {
+            onSeasons(doc.array().toVariantList());
+        }
+    });
+}
+
+int ApiClient::warmSeasonDetail(const QString &seasonId) {
+    QJsonDocument cached;
+    if (seasonId.trimmed().isEmpty() || m_seriesCache.lookup("season/" + seasonId, &cached)) {
+        return 0;
+    }
+    return warmRequest(QString("/api/v1/library/seasons/%1").arg(seasonId), [this, seasonId](const QJsonDocument &doc) {
+        if (doc.isObject()) {
+            m_seriesCache.insert("season/" + seasonId, doc);
+        }
+    });
+}
+
+int ApiClient::warmEpisodes(const QString &seasonId) {
+    QJsonDocument cached;
+    if (seasonId.trimmed().isEmpty() || m_seriesCache.lookup("episodes/" + seasonId, &cached)) {
+        return 0;
+    }
+    return warmRequest(QString("/api/v1/library/seasons/%1/episodes").arg(seasonId), [this, seasonId](const QJsonDocument &doc) {
+        if (doc.isArray()) {
+            m_seriesCache.insert("episodes/" + seasonId, doc);
+        }
+    });
+}
+
+int ApiClient::warmRequest(const QString &path, const SuccessHandler &onSuccess, const ErrorHandler &onError) {
+    if (m_baseUrl.trimmed().isEmpty()) {
+        return 0;
+    }
+    return sendRequest("GET", path, QJsonObject(), onSuccess, onError, false, ChunkHandler(), true);
+}
+
+QVariantMap ApiClient::normalizeDetails(const QJsonObject &object) {
+    QVariantMap details = object.toVariantMap();
+    const QVariant existingGenres = details.value("genres");
+    if (existingGenres.toList().isEmpty()) {
+        QVariantList parsed;
+        const QVariantMap meta = details.value("metadata").toMap();
+        const QVariant metaGenres = meta.value("genres");
+        if (metaGenres.canConvert<QVariantList>()) {
+            parsed = metaGenres.toList();
+        } else if (metaGenres.canConvert<QStringList>()) {
+            const QStringList list = metaGenres.toStringList();
+            for (const QString &value : list) {
+                parsed.append(value);
+            }
+        }
+        if (parsed.isEmpty()) {
+            const QString single = meta.value("genre").toString();
+            if (!single.trimmed().isEmpty()) {
+                parsed.append(single);
+            }
+        }
+        if (!parsed.isEmpty()) {
+            details.insert("genres", parsed);
+        }
+    }
+    return details;
+}
+
+void ApiClient::cacheMediaDetails(const QVariantMap &details) {
+    const QString id = details.value("id").toString();
+    if (id.isEmpty()) {
         return;
     }
-    sendRequest("GET", QString("/api/v1/library/series/%1/seasons").arg(seriesId), QJsonObject(),
+    auto *entry = new CachedDetails{details, QElapsedTimer()};
+    entry->age.start();
+    m_detailsCache.insert(id, entry);
+}
+
+int ApiClient::fetchSeasons(const QString &seriesId) {
+    if (seriesId.trimmed().isEmpty()) {
+        return 0;
+    }
+    QJsonDocument cached;
+    if (m_seriesCache.lookup("seasons/" + seriesId, &cached)) {
+        supersede("seasons", 0);
+        emit seasonsReceived(seriesId, cached.array().toVariantList());
+        return 0;
+    }
+    const int requestId = sendRequest("GET", QString("/api/v1/library/series/%1/seasons").arg(seriesId), QJsonObject(),
                 [this, seriesId](const QJsonDocument &doc) {
                     if (!doc.isArray()) {
                         emit requestFailed("/api/v1/library/series/:id/seasons", "Seasons response was not a list.");
                         return;
                     }
+                    m_seriesCache.insert("seasons/" + seriesId, doc);
                     emit seasonsReceived(seriesId, doc.array().toVariantList());
                 });
+    return supersede("seasons", requestId);
 }
 
-void ApiClient::fetchSeasonDetail(const QString &seasonId) {
+int ApiClient::fetchSeasonDetail(const QString &seasonId) {
     if (seasonId.trimmed().isEmpty()) {
-        return;
+        return 0;
+    }
+    QJsonDocument cached;
+    if (m_seriesCache.lookup("season/" + seasonId, &cached)) {
+        supersede("seasonDetail", 0);
+        emit seasonDetailReceived(seasonId, cached.object().toVariantMap());
+        return 0;
     }
-    sendRequest("GET", QString("/api/v1/library/seasons/%1").arg(seasonId), QJsonObject(),
+    const int requestId = sendRequest("GET", QString("/api/v1/library/seasons/%1").arg(seasonId), QJsonObject(),
                 [this, seasonId](const QJsonDocument &doc) {
                     if (!doc.isObject()) {
                         emit requestFailed("/api/v1/library/seasons/:id", "Season detail response was not an object.");
                         return;
                     }
+                    m_seriesCache.insert("season/" + seasonId, doc);
                     emit seasonDetailReceived(seasonId, doc.object().toVariantMap());
                 });
+    return supersede("seasonDetail", requestId);
 }
 
-void ApiClient::fetchEpisodes(const QString &seasonId) {
+int ApiClient::fetchEpisodes(const QString &seasonId) {
     if (seasonId.trimmed().isEmpty()) {
-        return;
+        return 0;
+    }
+    QJsonDocument cached;
+    if (m_seriesCache.lookup("episodes/" + seasonId, &cached)) {
+        supersede("episodes", 0);
+        emit episodesReceived(seasonId, cached.array().toVariantList());
+        return 0;
     }
-    sendRequest("GET", QString("/api/v1/library/seasons/%1/episodes").arg(seasonId), QJsonObject(),
+    const int requestId = sendRequest("GET", QString("/api/v1/library/seasons/%1/episodes").arg(seasonId), QJsonObject(),
                 [this, seasonId](const QJsonDocument &doc) {
                     if (!doc.isArray()) {
                         emit requestFailed("/api/v1/library/seasons/:id/episodes", "Episodes response was not a list.");
                         return;
                     }
+                    m_seriesCache.insert("episodes/" + seasonId, doc);
                     emit episodesReceived(seasonId, doc.array().toVariantList());
                 });
+    return supersede("episodes", requestId);
 }
 
 void ApiClient::startPlayback(const QString &mediaItemId, const QString &preferredFileId) {
@@ -288,7 +636,8 @@ void ApiClient::pollSession(const QString &sessionId) {
 
 void ApiClient::endSession(const QString &sessionId) {
     sendRequest("POST", QString("/api/v1/sessions/%1/end").arg(sessionId), QJsonObject(),
-                [](const QJsonDocument &) {},
+                // Watch progress in cached episode lists is stale now.
+                [this](const QJsonDocument &) { m_seriesCache.clear(); },
                 ErrorHandler(),
                 true);
 }
@@ -369,113 +718,545 @@ void ApiClient::applyReviewMatch(
         [this, reviewId](const QJsonDocument &) { emit reviewApplied(reviewId); });
 }
 
-QString ApiClient::normalizeBaseUrl(const QString &value) const {
-    QString trimmed = value.trimmed();
-    if (trimmed.isEmpty()) {
-        return trimmed;
+void ApiClient::clearResponseCache() {
+    m_responseCache.clear();
+    invalidateLibraryCaches();
+}
+
+void ApiClient::invalidateLibraryCaches() {
+    m_detailsCache.clear();
+    m_seriesCache.clear();
+}
+
+void ApiClient::warmConnection() {
+    if (!m_baseUrl.isEmpty()) {
+        m_http->preconnect(QUrl(m_baseUrl));
+    }
+}
+
+// Callers only share a reply when they would handle it the same way, so the
+// payload mode is part of the key along with the URL and the token.
+QString ApiClient::requestKey(const QString &method, const QUrl &url, bool allowNonJson, bool streamed) const {
+    const QByteArray authHash = m_authToken.isEmpty()
+        ? QByteArray()
+        : QCryptographicHash::hash(m_authToken.toUtf8(), QCryptographicHash::Sha1).toHex();
+    const QString mode = QString(allowNonJson ? "raw" : "json") + (streamed ? "+chunks" : "");
+    return QString("%1 %2 %3 %4").arg(method, url.toString(QUrl::FullyEncoded), QString::fromLatin1(authHash), mode);
+}
+
+// Cached responses outlive the token they were fetched with, so they are keyed
+// by the server URL and the account rather than the token itself.
+QString ApiClient::cacheKey(const QString &method, const QUrl &url, bool allowNonJson, bool streamed) const {
+    const QString mode = QString(allowNonJson ? "raw" : "json") + (streamed ? "+chunks" : "");
+    return QString("%1 %2 %3 %4").arg(method, url.toString(QUrl::FullyEncoded), m_accountId, mode);
+}
+
+bool ApiClient::isCacheablePath(const QString &path) const {
+    static const QRegularExpression cacheable(
+        "^/api/v1/library/(items(/[^/?]+)?|series/[^/?]+/seasons|seasons/[^/?]+(/episodes)?)$");
+    return cacheable.match(path).hasMatch();
+}
+
+ApiClient::RequestClass ApiClient::requestClassForPath(const QString &path) {
+    static const QRegularExpression details("^/api/v1/library/(items|review/queue)/[^/?]+$");
+    if (path == "/api/v1/play" || path.startsWith("/api/v1/sessions/") || path.startsWith("/api/v1/auth/")) {
+        return PlaybackClass;
+    }
+    if (details.match(path).hasMatch()) {
+        return DetailsClass;
+    }
+    if (path.startsWith("/api/v1/library/series/") || path.startsWith("/api/v1/library/seasons/")) {
+        return SeasonsClass;
     }
-    if (!trimmed.startsWith("http://") && !trimmed.startsWith("https://")) {
-        trimmed.prepend("http://");
+    if (path.startsWith("/api/v1/library/items")) {
+        return LibraryClass;
     }
-    while (trimmed.endsWith('/')) {
-        trimmed.chop(1);
+    return BackgroundClass;
+}
+
+int ApiClient::requestClassLimit(RequestClass requestClass) {
+    // Everything below playback stays under QNetworkAccessManager's six
+    // connections per host, so a play request always finds a free slot.
+    switch (requestClass) {
+        case PlaybackClass:
+            return 4;
+        case DetailsClass:
+            return 2;
+        default:
+            return 1;
     }
-    return trimmed;
 }
 
-QUrl ApiClient::makeUrl(const QString &path) const {
-    const QUrl base(normalizeBaseUrl(m_baseUrl));
-    QUrl relative(path.startsWith('/') ? path : QString("/%1").arg(path));
-    return base.resolved(relative);
+QVariantMap ApiClient::schedulerStats() const {
+    static const char *const names[RequestClassCount] = {"playback", "details", "seasons", "library", "background"};
+    QVariantMap stats{
+        {"warmConnections", m_warmRequests},
+        {"newConnections", m_coldRequests},
+    };
+    for (int i = 0; i < RequestClassCount; ++i) {
+        const ClassState &state = m_classes[i];
+        stats.insert(names[i], QVariantMap{
+            {"inFlight", state.inFlight},
+            {"queued", state.queue.size()},
+            {"limit", requestClassLimit(static_cast<RequestClass>(i))},
+            {"lastWaitMs", state.lastWaitMs},
+            {"maxWaitMs", state.maxWaitMs},
+        });
+    }
+    return stats;
 }
 
-void ApiClient::sendRequest(
+int ApiClient::sendRequest(
     const QString &method,
     const QString &path,
     const QJsonObject &body,
     const SuccessHandler &onSuccess,
     const ErrorHandler &onError,
-    bool allowNonJson) {
+    bool allowNonJson,
+    const ChunkHandler &onChunk,
+    bool speculative) {
     if (m_baseUrl.trimmed().isEmpty()) {
         const QString msg = "Base URL is not set.";
         if (onError) {
             onError(msg);
         }
         emit requestFailed(path, msg);
-        return;
+        return 0;
     }
 
+    const QUrl url = HttpCore::makeUrl(m_baseUrl, path);
+    const bool coalescable = method == "GET";
+    const QString key = coalescable
+        ? requestKey(method, url, allowNonJson, static_cast<bool>(onChunk))
+        : QString("#%1").arg(++m_requestSerial);
+    if (coalescable) {
+        auto existing = m_inFlight.find(key);
+        if (existing != m_inFlight.end() && onChunk) {
+            // A streamed reply feeds one chunk handler and completes once, so
+            // a second caller follows the first rather than waiting beside it.
+            qCInfo(lcApi) << "API streamed request already in flight" << method << path;
+            if (existing->speculative && !speculative) {
+                promoteRequest(key, requestClassForPath(path));
+            }
+            return existing->waiters.constFirst().id;
+        }
+        if (existing != m_inFlight.end()) {
+            const int requestId = ++m_nextRequestId;
+            existing->waiters.append({requestId, onSuccess, onError, speculative});
+            m_requestKeys.insert(requestId, key);
+            ++m_coalescedRequestCount;
+            qCInfo(lcApi) << "API request coalesced" << method << path
+                    << "waiters" << existing->waiters.size();
+            emit coalescedRequestCountChanged();
+            if (existing->speculative && !speculative) {
+                promoteRequest(key, requestClassForPath(path));
+            }
+            return requestId;
+        }
+    }
+
+    const RequestClass requestClass = speculative ? BackgroundClass : requestClassForPath(path);
     const QStringList bodyKeys = body.keys();
-    qInfo() << "API request" << method << path << "base" << m_baseUrl
-            << "keys" << bodyKeys;
+    qCInfo(lcApi) << "API request" << method << path << "base" << m_baseUrl
+            << "keys" << bodyKeys << "class" << requestClass;
 
-    QNetworkRequest request(makeUrl(path));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    QNetworkRequest request = HttpCore::makeRequest(url, m_authToken);
     const QString locale = QLocale::system().name().replace('_', '-');
     if (!locale.trimmed().isEmpty()) {
         request.setRawHeader("Accept-Language", locale.toUtf8());
     }
-    if (!m_authToken.isEmpty()) {
-        request.setRawHeader("Authorization", QByteArray("Bearer ") + m_authToken.toUtf8());
+    if (requestClass == PlaybackClass) {
+        request.setPriority(QNetworkRequest::HighPriority);
+    } else if (requestClass == BackgroundClass) {
+        request.setPriority(QNetworkRequest::LowPriority);
+    }
+    const bool cacheable = coalescable && isCacheablePath(path);
+    const QString diskKey = cacheable ? cacheKey(method, url, allowNonJson, static_cast<bool>(onChunk)) : QString();
+    if (cacheable) {
+        const ResponseCache::Validators validators = m_responseCache.validators(diskKey);
+        if (!validators.etag.isEmpty()) {
+            request.setRawHeader("If-None-Match", validators.etag);
+        }
+        if (!validators.lastModified.isEmpty()) {
+            request.setRawHeader("If-Modified-Since", validators.lastModified);
+        }
+    }
+
+    PendingRequest pending;
+    pending.method = method;
+    pending.path = path;
+    pending.cacheKey = diskKey;
+    pending.requestClass = requestClass;
+    pending.allowNonJson = allowNonJson;
+    pending.onChunk = coalescable ? onChunk : ChunkHandler();
+    pending.speculative = speculative;
+    const int requestId = ++m_nextRequestId;
+    pending.waiters.append({requestId, onSuccess, onError, speculative});
+    pending.traceId = requestId;
+    m_requestKeys.insert(requestId, key);
+    m_inFlight.insert(key, pending);
+    TraceRecorder::asyncBegin("queued", "api", requestId, method + " " + path);
+
+    QueuedRequest queued;
+    queued.key = key;
+    queued.method = method;
+    queued.request = request;
+    queued.body = method == "GET" ? QByteArray() : QJsonDocument(body).toJson();
+    queued.queuedAt.start();
+    m_classes[requestClass].queue.enqueue(queued);
+    pumpQueues();
+    emit schedulerStatsChanged();
+    return requestId;
+}
+
+int ApiClient::supersede(const QString &kind, int requestId) {
+    const int previous = m_latestRequests.value(kind);
+    if (previous != 0 && previous != requestId) {
+        cancelRequest(previous);
+    }
+    if (requestId != 0) {
+        m_latestRequests.insert(kind, requestId);
+    }
+    return requestId;
+}
+
+void ApiClient::cancelRequest(int requestId) {
+    const QString key = m_requestKeys.take(requestId);
+    auto it = m_inFlight.find(key);
+    if (key.isEmpty() || it == m_inFlight.end()) {
+        return;
+    }
+    for (int i = 0; i < it->waiters.size(); ++i) {
+        if (it->waiters.at(i).id == requestId) {
+            it->waiters.removeAt(i);
+            break;
+        }
+    }
+    if (!it->waiters.isEmpty()) {
+        return;
     }
 
-    QNetworkReply *reply = nullptr;
-    if (method == "GET") {
-        reply = m_manager.get(request);
-    } else if (method == "POST") {
-        reply = m_manager.post(request, QJsonDocument(body).toJson());
+    const PendingRequest request = it.value();
+    m_inFlight.erase(it);
+    qCInfo(lcApi) << "API request cancelled" << request.path;
+    m_responseCache.finishStore(request.cacheWriter, false);
+    if (request.reply) {
+        TraceRecorder::asyncEnd("network", "api", request.traceId);
+        request.reply->abort();
     } else {
-        reply = m_manager.sendCustomRequest(request, method.toUtf8(), QJsonDocument(body).toJson());
-    }
-
-    connect(reply, &QNetworkReply::finished, this, [this, reply, path, onSuccess, onError, allowNonJson]() {
-        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        const QByteArray payload = reply->readAll();
-        const bool okStatus = status >= 200 && status < 300;
-        qInfo() << "API response" << path << "status" << status
-                << "bytes" << payload.size() << "error" << reply->error();
-
-        if (reply->error() != QNetworkReply::NoError || !okStatus) {
-            const QString detail = payload.isEmpty()
-                ? reply->errorString()
-                : QString::fromUtf8(payload);
-            if (status == 401 && !path.startsWith("/api/v1/auth/")) {
-                setAuthToken(QString());
-                setAccessTokenExpiresAt(QString());
-                emit authExpired(detail.isEmpty() ? "Authentication expired." : detail);
-            }
-            if (onError) {
-                onError(detail);
+        TraceRecorder::asyncEnd("queued", "api", request.traceId);
+        QQueue<QueuedRequest> &queue = m_classes[request.requestClass].queue;
+        for (int i = 0; i < queue.size(); ++i) {
+            if (queue.at(i).key == key) {
+                queue.removeAt(i);
+                break;
             }
-            emit requestFailed(path, detail);
-            reply->deleteLater();
-            return;
         }
+        emit schedulerStatsChanged();
+    }
+}
+
+void ApiClient::promoteRequest(const QString &key, RequestClass requestClass) {
+    auto it = m_inFlight.find(key);
+    if (it == m_inFlight.end()) {
+        return;
+    }
+    it->speculative = false;
+    if (it->reply || it->requestClass == requestClass) {
+        return;
+    }
+    QQueue<QueuedRequest> &queue = m_classes[it->requestClass].queue;
+    for (int i = 0; i < queue.size(); ++i) {
+        if (queue.at(i).key == key) {
+            QueuedRequest queued = queue.takeAt(i);
+            queued.request.setPriority(QNetworkRequest::NormalPriority);
+            m_classes[requestClass].queue.prepend(queued);
+            it->requestClass = requestClass;
+            break;
+        }
+    }
+    pumpQueues();
+    emit schedulerStatsChanged();
+}
+
+void ApiClient::pumpQueues() {
+    for (int i = 0; i < RequestClassCount; ++i) {
+        const RequestClass requestClass = static_cast<RequestClass>(i);
+        ClassState &state = m_classes[i];
+        // Only playback may take the last connection to a host.
+        const int reserved = requestClass == PlaybackClass ? 0 : 1;
+        while (!state.queue.isEmpty() && state.inFlight < requestClassLimit(requestClass)
+               && m_http->hasCapacity(state.queue.head().request.url(), reserved)) {
+            dispatchRequest(requestClass, state.queue.dequeue());
+        }
+    }
+}
 
-        if (!onSuccess) {
+void ApiClient::dispatchRequest(RequestClass requestClass, QueuedRequest queued) {
+    auto it = m_inFlight.find(queued.key);
+    if (it == m_inFlight.end()) {
+        return;
+    }
+
+    ClassState &state = m_classes[requestClass];
+    state.lastWaitMs = queued.queuedAt.elapsed();
+    state.maxWaitMs = qMax(state.maxWaitMs, state.lastWaitMs);
+    ++state.inFlight;
+    if (state.lastWaitMs > 0) {
+        qCInfo(lcApi) << "API request dispatched" << it->path << "waited ms" << state.lastWaitMs;
+    }
+
+    TraceRecorder::asyncEnd("queued", "api", it->traceId);
+    TraceRecorder::asyncBegin("network", "api", it->traceId, it->method + " " + it->path);
+    QNetworkReply *reply = m_http->send(queued.method, queued.request, queued.body, m_networkType);
+    it->reply = reply;
+
+    const QString key = queued.key;
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [this, reply, key]() {
+        auto it = m_inFlight.find(key);
+        if (it != m_inFlight.end() && it->reply == reply) {
+            it->newConnection = true;
+        }
+    });
+    if (it->onChunk) {
+        connect(reply, &QNetworkReply::readyRead, this, [this, reply, key]() {
+            streamReply(reply, key);
+        });
+    }
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, key, requestClass]() {
+        --m_classes[requestClass].inFlight;
+        auto it = m_inFlight.find(key);
+        const bool current = it != m_inFlight.end() && it->reply == reply;
+        PendingRequest request;
+        if (current) {
+            request = it.value();
+            m_inFlight.erase(it);
+            ++(request.newConnection ? m_coldRequests : m_warmRequests);
+            TraceRecorder::asyncEnd("network", "api", request.traceId);
+        }
+        pumpQueues();
+        emit schedulerStatsChanged();
+
+        if (!current) {
             reply->deleteLater();
             return;
         }
+        completeRequest(reply, request);
+    });
+}
 
-        QJsonParseError parseError;
-        const QJsonDocument doc = QJsonDocument::fromJson(payload, &parseError);
-        if (parseError.error != QJsonParseError::NoError) {
-            if (allowNonJson) {
-                qInfo() << "API response (non-JSON)" << path << "bytes" << payload.size();
-                onSuccess(QJsonDocument());
-                reply->deleteLater();
-                return;
-            }
-            const QString detail = QString("Invalid JSON: %1").arg(parseError.errorString());
-            if (onError) {
-                onError(detail);
-            }
-            emit requestFailed(path, detail);
-            reply->deleteLater();
+void ApiClient::streamReply(QNetworkReply *reply, const QString &key) {
+    auto it = m_inFlight.find(key);
+    if (it == m_inFlight.end() || it->reply != reply || !it->onChunk) {
+        return;
+    }
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status < 200 || status >= 300) {
+        return;
+    }
+    if (!it->cacheKey.isEmpty() && !it->cacheWriter) {
+        it->cacheWriter = m_responseCache.beginStore(
+            it->cacheKey, reply->rawHeader("ETag"), reply->rawHeader("Last-Modified"));
+    }
+
+    const QByteArray chunk = reply->readAll();
+    if (it->cacheWriter) {
+        it->cacheWriter->write(chunk);
+    }
+    const ChunkHandler onChunk = it->onChunk;
+    if (onChunk(chunk, false)) {
+        return;
+    }
+    // The parser gave up, so stop the download rather than feed it the rest.
+    it = m_inFlight.find(key);
+    if (it == m_inFlight.end() || it->reply != reply) {
+        return;
+    }
+    const PendingRequest request = it.value();
+    m_inFlight.erase(it);
+    TraceRecorder::asyncEnd("network", "api", request.traceId);
+    m_responseCache.finishStore(request.cacheWriter, false);
+    reply->abort();
+    failRequest(request, "Streamed response was not a JSON list.");
+}
+
+void ApiClient::completeRequest(QNetworkReply *reply, const PendingRequest &request) {
+    const QString &path = request.path;
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QByteArray payload = reply->readAll();
+    const bool okStatus = status >= 200 && status < 300;
+    qCInfo(lcApi) << "API response" << path << "status" << status
+            << "bytes" << payload.size() << "error" << reply->error()
+            << "waiters" << request.waiters.size()
+            << "warm" << !request.newConnection
+            << "http2" << reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+    reply->deleteLater();
+
+    if (status == 304 && !request.cacheKey.isEmpty()) {
+        replayCachedResponse(request);
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError || !okStatus) {
+        const QString detail = request.onChunk && okStatus
+            ? reply->errorString()
+            : HttpCore::errorDetail(reply, payload);
+        if (status == 401 && !path.startsWith("/api/v1/auth/")) {
+            setAuthToken(QString());
+            setAccessTokenExpiresAt(QString());
+            emit authExpired(detail.isEmpty() ? "Authentication expired." : detail);
+        }
+        m_responseCache.finishStore(request.cacheWriter, false);
+        failRequest(request, detail, status);
+        return;
+    }
+
+    if (request.onChunk) {
+        if (request.cacheWriter) {
+            request.cacheWriter->write(payload);
+        }
+        const bool streamed = request.onChunk(payload, true);
+        m_responseCache.finishStore(request.cacheWriter, streamed);
+        if (!streamed) {
+            failRequest(request, "Streamed response was not a JSON list.");
+        } else {
+            succeedRequest(request, QJsonDocument());
+        }
+        return;
+    }
+
+    bool wantsDocument = false;
+    for (const RequestWaiter &waiter : request.waiters) {
+        wantsDocument = wantsDocument || (waiter.onSuccess && m_requestKeys.contains(waiter.id));
+    }
+    if (!wantsDocument) {
+        succeedRequest(request, QJsonDocument());
+        return;
+    }
+
+    const QByteArray etag = reply->rawHeader("ETag");
+    const QByteArray lastModified = reply->rawHeader("Last-Modified");
+    if (payload.size() < kInlineParseBytes) {
+        finishParsedRequest(request, payload, etag, lastModified, parsePayload(payload));
+        return;
+    }
+    QtConcurrent::run(&ApiClient::parsePayload, payload)
+        .then(this, [this, request, payload, etag, lastModified](const ParsedPayload &parsed) {
+            finishParsedRequest(request, payload, etag, lastModified, parsed);
+        });
+}
+
+void ApiClient::finishParsedRequest(
+    const PendingRequest &request,
+    const QByteArray &payload,
+    const QByteArray &etag,
+    const QByteArray &lastModified,
+    const ParsedPayload &parsed) {
+    TraceSpan span("finish request", "api");
+    m_http->metrics()->recordParse(
+        NetworkMetrics::endpointTemplate(request.method, QUrl(request.path)), m_networkType, parsed.elapsedMs);
+    if (payload.size() >= kInlineParseBytes) {
+        qCInfo(lcApi) << "API parse" << request.path << "bytes" << payload.size()
+                << "ms" << parsed.elapsedMs << "backend" << JsonBackend::name();
+    }
+    if (parsed.error.error != QJsonParseError::NoError) {
+        if (!request.allowNonJson) {
+            failRequest(request, QString("Invalid JSON: %1").arg(parsed.error.errorString()));
             return;
         }
+        qCInfo(lcApi) << "API response (non-JSON)" << request.path << "bytes" << payload.size();
+        succeedRequest(request, QJsonDocument());
+        return;
+    }
+    if (!request.cacheKey.isEmpty() && m_responseCache.accepts(etag, lastModified, payload.size())) {
+        const QString key = request.cacheKey;
+        QtConcurrent::run([path = m_responseCache.filePath(key), etag, lastModified, payload]() {
+            TraceSpan span("cache store", "api");
+            return ResponseCache::writeFile(path, etag, lastModified, payload);
+        }).then(this, [this, key, doc = parsed.doc, bytes = payload.size()](std::optional<qint64> grownBy) {
+            if (grownBy) {
+                m_responseCache.stored(key, *grownBy, doc, bytes);
+            }
+        });
+    }
+    succeedRequest(request, parsed.doc);
+}
 
-        onSuccess(doc);
-        reply->deleteLater();
+// Answers a 304 from the cache. A document still held in memory is used
+// directly; otherwise the file is read, and parsed or fed to the chunk
+// handler, off the GUI thread. Signals the chunk handler emits there reach
+// their receivers queued, ahead of the completion delivered back here.
+void ApiClient::replayCachedResponse(const PendingRequest &request) {
+    QJsonDocument cached;
+    if (!request.onChunk && m_responseCache.cachedDocument(request.cacheKey, &cached)) {
+        qCInfo(lcApi) << "API response (not modified)" << request.path;
+        succeedRequest(request, cached);
+        return;
+    }
+    QtConcurrent::run([path = m_responseCache.filePath(request.cacheKey), onChunk = request.onChunk]() {
+        TraceSpan span("cache replay", "api");
+        CachedPayload loaded;
+        QByteArray payload;
+        if (!ResponseCache::readFile(path, &payload)) {
+            return loaded;
+        }
+        loaded.bytes = payload.size();
+        if (onChunk) {
+            loaded.ok = onChunk(payload, true);
+            return loaded;
+        }
+        const ParsedPayload parsed = parsePayload(payload);
+        loaded.doc = parsed.doc;
+        loaded.ok = parsed.error.error == QJsonParseError::NoError;
+        return loaded;
+    }).then(this, [this, request](const CachedPayload &loaded) {
+        if (!loaded.ok) {
+            m_responseCache.remove(request.cacheKey);
+            failRequest(request, "Cached response is no longer available.");
+            return;
+        }
+        if (!request.onChunk) {
+            m_responseCache.remember(request.cacheKey, loaded.doc, loaded.bytes);
+        }
+        qCInfo(lcApi) << "API response (not modified)" << request.path << "bytes" << loaded.bytes;
+        succeedRequest(request, loaded.doc);
     });
 }
+
+void ApiClient::failRequest(const PendingRequest &request, const QString &detail, int status) {
+    const int previousStatus = std::exchange(m_failureStatus, status);
+    bool live = false;
+    for (const RequestWaiter &waiter : request.waiters) {
+        if (!m_requestKeys.remove(waiter.id)) {
+            continue;
+        }
+        live = live || !waiter.speculative;
+        if (waiter.onError) {
+            waiter.onError(detail);
+        }
+    }
+    m_failureStatus = previousStatus;
+    if (live) {
+        emit requestFailed(request.path, detail);
+    }
+}
+
+void ApiClient::succeedRequest(const PendingRequest &request, const QJsonDocument &doc) {
+    TraceSpan span("callbacks", "api");
+    for (const RequestWaiter &waiter : request.waiters) {
+        if (m_requestKeys.remove(waiter.id) && waiter.onSuccess) {
+            waiter.onSuccess(doc);
+        }
+    }
+}
+
+ApiClient::ParsedPayload ApiClient::parsePayload(const QByteArray &payload) {
+    TraceSpan span("parse", "api");
+    QElapsedTimer timer;
+    timer.start();
+    ParsedPayload parsed;
+    parsed.doc = JsonBackend::parse(payload, &parsed.error);
+    parsed.elapsedMs = timer.elapsed();
+    return parsed;
+}
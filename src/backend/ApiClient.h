@@ -1,30 +1,52 @@
 #pragma once
 
 #include <QObject>
-#include <QNetworkAccessManager>
+#include <QByteArrayList>
+#include <QCache>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QJsonObject>
+#include <QNetworkRequest>
+#include <QQueue>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
 #include <QUrl>
 #include <QVariant>
+#include <QVector>
 #include <functional>
+#include <memory>
 
-class QJsonDocument;
+#include "backend/ResponseCache.h"
+#include "backend/SeriesCache.h"
+
+class HttpCore;
+class QNetworkReply;
+class QSaveFile;
 
 class ApiClient : public QObject {
     Q_OBJECT
     Q_PROPERTY(QString baseUrl READ baseUrl WRITE setBaseUrl NOTIFY baseUrlChanged)
     Q_PROPERTY(QString authToken READ authToken WRITE setAuthToken NOTIFY authTokenChanged)
+    Q_PROPERTY(QString accountId READ accountId NOTIFY accountIdChanged)
     Q_PROPERTY(QString accessTokenExpiresAt READ accessTokenExpiresAt WRITE setAccessTokenExpiresAt NOTIFY accessTokenExpiresAtChanged)
     Q_PROPERTY(QVariantMap clientCapabilities READ clientCapabilities WRITE setClientCapabilities NOTIFY clientCapabilitiesChanged)
     Q_PROPERTY(QString networkType READ networkType WRITE setNetworkType NOTIFY networkTypeChanged)
+    Q_PROPERTY(int coalescedRequestCount READ coalescedRequestCount NOTIFY coalescedRequestCountChanged)
+    Q_PROPERTY(QVariantMap schedulerStats READ schedulerStats NOTIFY schedulerStatsChanged)
 
 public:
-    explicit ApiClient(QObject *parent = nullptr);
+    explicit ApiClient(HttpCore *http, QObject *parent = nullptr);
 
     QString baseUrl() const;
     void setBaseUrl(const QString &value);
 
     QString authToken() const;
     void setAuthToken(const QString &value);
+    // Stable across token refreshes; empty when signed out.
+    QString accountId() const;
 
     QString accessTokenExpiresAt() const;
     void setAccessTokenExpiresAt(const QString &value);
@@ -35,15 +57,25 @@ public:
     QString networkType() const;
     void setNetworkType(const QString &value);
 
+    int coalescedRequestCount() const;
+    QVariantMap schedulerStats() const;
+
     Q_INVOKABLE void login(const QString &email, const QString &password);
     Q_INVOKABLE void signup(const QString &email, const QString &password);
     Q_INVOKABLE void startPasswordReset(const QString &email);
     Q_INVOKABLE void completePasswordReset(const QString &token, const QString &newPassword);
     Q_INVOKABLE void fetchLibrary();
-    Q_INVOKABLE void fetchMediaDetails(const QString &mediaItemId);
-    Q_INVOKABLE void fetchSeasons(const QString &seriesId);
-    Q_INVOKABLE void fetchSeasonDetail(const QString &seasonId);
-    Q_INVOKABLE void fetchEpisodes(const QString &seasonId);
+    Q_INVOKABLE void fetchLibraryChanges(const QString &since);
+    Q_INVOKABLE void syncLibrary(const QString &since);
+    Q_INVOKABLE int fetchMediaDetails(const QString &mediaItemId);
+    // Revalidates cached details at background priority; mediaDetailsReceived
+    // fires only if they changed, and failures stay silent.
+    Q_INVOKABLE int refreshMediaDetails(const QString &mediaItemId);
+    Q_INVOKABLE void prefetchMediaDetails(const QStringList &mediaItemIds);
+    Q_INVOKABLE QVariantMap cachedMediaDetails(const QString &mediaItemId);
+    Q_INVOKABLE int fetchSeasons(const QString &seriesId);
+    Q_INVOKABLE int fetchSeasonDetail(const QString &seasonId);
+    Q_INVOKABLE int fetchEpisodes(const QString &seasonId);
     Q_INVOKABLE void startPlayback(const QString &mediaItemId, const QString &preferredFileId);
     Q_INVOKABLE void seekPlayback(const QString &sessionId, double seconds);
     Q_INVOKABLE void pollSession(const QString &sessionId);
@@ -52,13 +84,25 @@ public:
     Q_INVOKABLE void fetchReviewQueue(const QString &status, int limit, int offset);
     Q_INVOKABLE void fetchReviewQueueDetail(const QString &reviewId);
     Q_INVOKABLE void applyReviewMatch(const QString &reviewId, const QString &libraryType, const QVariantMap &externalIds, const QString &normalizedKey = QString());
+    Q_INVOKABLE void clearResponseCache();
+    Q_INVOKABLE void cancelRequest(int requestId);
+    Q_INVOKABLE void warmConnection();
+
+    // Speculative fetches: background priority, no signals, silent on failure.
+    int warmMediaDetails(const QString &mediaItemId);
+    int warmSeasons(const QString &seriesId, const std::function<void(const QVariantList &)> &onSeasons);
+    int warmSeasonDetail(const QString &seasonId);
+    int warmEpisodes(const QString &seasonId);
 
 signals:
     void baseUrlChanged();
     void authTokenChanged();
+    void accountIdChanged();
     void accessTokenExpiresAtChanged();
     void clientCapabilitiesChanged();
     void networkTypeChanged();
+    void coalescedRequestCountChanged();
+    void schedulerStatsChanged();
 
     void loginSucceeded();
     void loginFailed(const QString &error);
@@ -66,7 +110,13 @@ signals:
     void passwordResetStarted(const QString &token, const QString &expiresAt);
     void passwordResetCompleted();
     void passwordResetFailed(const QString &error);
-    void libraryReceived(const QVariantList &items);
+    void libraryStreamStarted();
+    void libraryItemsReceived(const QByteArrayList &items);
+    void libraryStreamAborted();
+    void libraryReceived();
+    void libraryDeltaReceived(const QJsonArray &items, const QStringList &removedIds);
+    // A changes request answered with the whole library.
+    void libraryReplaced(const QJsonArray &items);
     void mediaDetailsReceived(const QVariantMap &details);
     void seasonsReceived(const QString &seriesId, const QVariantList &seasons);
     void seasonDetailReceived(const QString &seasonId, const QVariantMap &detail);
@@ -84,20 +134,130 @@ signals:
 private:
     using SuccessHandler = std::function<void(const QJsonDocument &)>;
     using ErrorHandler = std::function<void(const QString &)>;
+    using ChunkHandler = std::function<bool(const QByteArray &, bool)>;
+
+    enum RequestClass {
+        PlaybackClass,
+        DetailsClass,
+        SeasonsClass,
+        LibraryClass,
+        BackgroundClass,
+        RequestClassCount
+    };
+
+    struct RequestWaiter {
+        int id = 0;
+        SuccessHandler onSuccess;
+        ErrorHandler onError;
+        bool speculative = false;
+    };
+
+    struct PendingRequest {
+        QNetworkReply *reply = nullptr;
+        QString method;
+        QString path;
+        QString cacheKey;
+        RequestClass requestClass = BackgroundClass;
+        bool newConnection = false;
+        bool allowNonJson = false;
+        bool speculative = false;
+        int traceId = 0;
+        ChunkHandler onChunk;
+        std::shared_ptr<QSaveFile> cacheWriter;
+        QVector<RequestWaiter> waiters;
+    };
+
+    struct QueuedRequest {
+        QString key;
+        QString method;
+        QNetworkRequest request;
+        QByteArray body;
+        QElapsedTimer queuedAt;
+    };
+
+    struct ClassState {
+        QQueue<QueuedRequest> queue;
+        int inFlight = 0;
+        qint64 lastWaitMs = 0;
+        qint64 maxWaitMs = 0;
+    };
+
+    struct ParsedPayload {
+        QJsonDocument doc;
+        QJsonParseError error;
+        qint64 elapsedMs = 0;
+    };
+
+    struct CachedPayload {
+        QJsonDocument doc;
+        qint64 bytes = 0;
+        bool ok = false;
+    };
+
+    struct CachedDetails {
+        QVariantMap details;
+        QElapsedTimer age;
+    };
 
-    QString normalizeBaseUrl(const QString &value) const;
-    QUrl makeUrl(const QString &path) const;
-    void sendRequest(
+    QString requestKey(const QString &method, const QUrl &url, bool allowNonJson, bool streamed) const;
+    QString cacheKey(const QString &method, const QUrl &url, bool allowNonJson, bool streamed) const;
+    bool isCacheablePath(const QString &path) const;
+    static RequestClass requestClassForPath(const QString &path);
+    static int requestClassLimit(RequestClass requestClass);
+    int sendRequest(
         const QString &method,
         const QString &path,
         const QJsonObject &body,
         const SuccessHandler &onSuccess,
         const ErrorHandler &onError = ErrorHandler(),
-        bool allowNonJson = false);
+        bool allowNonJson = false,
+        const ChunkHandler &onChunk = ChunkHandler(),
+        bool speculative = false);
+    int supersede(const QString &kind, int requestId);
+    void promoteRequest(const QString &key, RequestClass requestClass);
+    void pumpQueues();
+    void dispatchRequest(RequestClass requestClass, QueuedRequest queued);
+    void streamReply(QNetworkReply *reply, const QString &key);
+    void completeRequest(QNetworkReply *reply, const PendingRequest &request);
+    void finishParsedRequest(
+        const PendingRequest &request,
+        const QByteArray &payload,
+        const QByteArray &etag,
+        const QByteArray &lastModified,
+        const ParsedPayload &parsed);
+    void replayCachedResponse(const PendingRequest &request);
+    void failRequest(const PendingRequest &request, const QString &detail, int status = 0);
+    void succeedRequest(const PendingRequest &request, const QJsonDocument &doc);
+    static ParsedPayload parsePayload(const QByteArray &payload);
+    static QVariantMap normalizeDetails(const QJsonObject &object);
+    void cacheMediaDetails(const QVariantMap &details);
+    void invalidateLibraryCaches();
+    void flushDetailsPrefetch();
+    void prefetchDetailsIndividually(const QStringList &mediaItemIds);
+    int warmRequest(const QString &path, const SuccessHandler &onSuccess, const ErrorHandler &onError = ErrorHandler());
 
-    QNetworkAccessManager m_manager;
+    HttpCore *m_http = nullptr;
+    QHash<QString, PendingRequest> m_inFlight;
+    ResponseCache m_responseCache;
+    int m_coalescedRequestCount = 0;
+    quint64 m_requestSerial = 0;
+    ClassState m_classes[RequestClassCount];
+    int m_warmRequests = 0;
+    int m_coldRequests = 0;
+    int m_nextRequestId = 0;
+    QHash<int, QString> m_requestKeys;
+    QHash<QString, int> m_latestRequests;
+    QCache<QString, CachedDetails> m_detailsCache;
+    SeriesCache m_seriesCache;
+    QStringList m_detailsPrefetchQueue;
+    QSet<QString> m_detailsPrefetching;
+    QTimer m_detailsPrefetchTimer;
+    bool m_batchDetailsSupported = true;
+    // HTTP status of the failure whose error handlers are running, 0 if none.
+    int m_failureStatus = 0;
     QString m_baseUrl;
     QString m_authToken;
+    QString m_accountId;
     QString m_accessTokenExpiresAt;
     QVariantMap m_clientCapabilities;
     QString m_networkType;
@@ -0,0 +1,220 @@
+#include "backend/AsyncLogger.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace {
+constexpr size_t kRingCapacity = 8192;
+constexpr int kBatchLines = 512;
+constexpr qint64 kMaxLogBytes = 8 * 1024 * 1024;
+constexpr int kKeepRotatedFiles = 3;
+constexpr unsigned long kIdleWaitMs = 25;
+
+// Bounded multi-producer queue (Vyukov); only the writer thread pops.
+class LogRing {
+public:
+    LogRing()
+        : m_slots(new Slot[kRingCapacity]) {
+        for (size_t i = 0; i < kRingCapacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(QByteArray &&line) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Slot *slot = nullptr;
+        for (;;) {
+            slot = &m_slots[pos & (kRingCapacity - 1)];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<qptrdiff>(sequence) - static_cast<qptrdiff>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->line = std::move(line);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(QByteArray *line) {
+        Slot &slot = m_slots[m_dequeuePos & (kRingCapacity - 1)];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != m_dequeuePos + 1) {
+            return false;
+        }
+        *line = std::move(slot.line);
+        slot.line = QByteArray();
+        slot.sequence.store(m_dequeuePos + kRingCapacity, std::memory_order_release);
+        ++m_dequeuePos;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        QByteArray line;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<size_t> m_enqueuePos{0};
+    alignas(64) size_t m_dequeuePos = 0;
+};
+
+struct LoggerState {
+    LogRing ring;
+    QString path;
+    QFile file;
+    QThread *writer = nullptr;
+    std::atomic<bool> running{false};
+    std::atomic<quint64> dropped{0};
+    quint64 reportedDropped = 0;
+};
+
+LoggerState *g_logger = nullptr;
+
+const char *logLevelName(QtMsgType type) {
+    switch (type) {
+        case QtDebugMsg:
+            return "DEBUG";
+        case QtInfoMsg:
+            return "INFO";
+        case QtWarningMsg:
+            return "WARN";
+        case QtCriticalMsg:
+            return "CRITICAL";
+        case QtFatalMsg:
+            return "FATAL";
+    }
+    return "LOG";
+}
+
+void openLogFile(LoggerState *state) {
+    if (state->path.isEmpty()) {
+        return;
+    }
+    state->file.setFileName(state->path);
+    state->file.open(QIODevice::Append);
+}
+
+void rotateIfNeeded(LoggerState *state) {
+    if (!state->file.isOpen() || state->file.size() < kMaxLogBytes) {
+        return;
+    }
+    state->file.close();
+    QFile::remove(QString("%1.%2").arg(state->path).arg(kKeepRotatedFiles));
+    for (int i = kKeepRotatedFiles - 1; i >= 1; --i) {
+        QFile::rename(QString("%1.%2").arg(state->path).arg(i), QString("%1.%2").arg(state->path).arg(i + 1));
+    }
+    QFile::rename(state->path, state->path + ".1");
+    openLogFile(state);
+}
+
+bool drainBatch(LoggerState *state) {
+    QByteArray batch;
+    QByteArray line;
+    int lines = 0;
+    while (lines < kBatchLines && state->ring.pop(&line)) {
+        batch += line;
+        batch += '\n';
+        ++lines;
+    }
+
+    const quint64 dropped = state->dropped.load(std::memory_order_relaxed);
+    if (dropped != state->reportedDropped) {
+        batch += QString("%1 [WARN] logger: dropped %2 message(s), %3 total\n")
+            .arg(QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs))
+            .arg(dropped - state->reportedDropped)
+            .arg(dropped)
+            .toUtf8();
+        state->reportedDropped = dropped;
+    }
+    if (batch.isEmpty()) {
+        return false;
+    }
+
+    if (state->file.isOpen()) {
+        state->file.write(batch);
+        state->file.flush();
+        rotateIfNeeded(state);
+    }
+    fwrite(batch.constData(), 1, static_cast<size_t>(batch.size()), stderr);
+    fflush(stderr);
+    return lines == kBatchLines;
+}
+
+void writerLoop(LoggerState *state) {
+    while (state->running.load(std::memory_order_acquire)) {
+        if (!drainBatch(state)) {
+            QThread::msleep(kIdleWaitMs);
+        }
+    }
+    while (drainBatch(state)) {
+    }
+}
+
+void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
+    QString line = QString("%1 [%2] %3: %4")
+        .arg(QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs),
+             QLatin1String(logLevelName(type)),
+             QString::fromUtf8(context.category ? context.category : ""),
+             msg);
+    if (context.file && context.line > 0) {
+        line.append(QString(" (%1:%2)").arg(context.file).arg(context.line));
+    }
+
+    LoggerState *state = g_logger;
+    if (!state || !state->running.load(std::memory_order_acquire)) {
+        fprintf(stderr, "%s\n", line.toUtf8().constData());
+    } else if (!state->ring.push(line.toUtf8())) {
+        state->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (type == QtFatalMsg) {
+        AsyncLogger::shutdown();
+        abort();
+    }
+}
+} // namespace
+
+void AsyncLogger::install(const QString &logPath) {
+    if (g_logger) {
+        return;
+    }
+    g_logger = new LoggerState;
+    g_logger->path = logPath;
+    openLogFile(g_logger);
+    g_logger->running.store(true, std::memory_order_release);
+    LoggerState *state = g_logger;
+    g_logger->writer = QThread::create([state]() { writerLoop(state); });
+    g_logger->writer->setObjectName("AsyncLogger");
+    g_logger->writer->start(QThread::LowPriority);
+    qInstallMessageHandler(messageHandler);
+}
+
+void AsyncLogger::shutdown() {
+    LoggerState *state = g_logger;
+    if (!state || !state->running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (state->writer->isRunning() && QThread::currentThread() != state->writer) {
+        state->writer->wait();
+    }
+    state->file.close();
+}
+
+quint64 AsyncLogger::droppedMessages() {
+    return g_logger ? g_logger->dropped.load(std::memory_order_relaxed) : 0;
+}
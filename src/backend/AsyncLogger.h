@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+// Installs a Qt message handler that formats on the calling thread, pushes
+// into a lock-free ring and leaves file/stderr I/O to one writer thread.
+namespace AsyncLogger {
+    void install(const QString &logPath);
+    void shutdown();
+    quint64 droppedMessages();
+}
@@ -1,18 +1,23 @@
 #include "backend/ControlPlaneClient.h"
 
+#include "backend/HttpCore.h"
+
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkReply>
+#include <QtConcurrent/QtConcurrentRun>
+#include <utility>
 
-ControlPlaneClient::ControlPlaneClient(QObject *parent)
-    : QObject(parent) {}
+ControlPlaneClient::ControlPlaneClient(HttpCore *http, QObject *parent)
+    : QObject(parent),
+      m_http(http) {}
 
 QString ControlPlaneClient::baseUrl() const {
     return m_baseUrl;
 }
 
 void ControlPlaneClient::setBaseUrl(const QString &value) {
-    const QString normalized = normalizeBaseUrl(value);
+    const QString normalized = HttpCore::normalizeBaseUrl(value);
     if (m_baseUrl == normalized) {
         return;
     }
@@ -94,26 +99,6 @@ void ControlPlaneClient::signup(const QString &email, const QString &password) {
         [this](const QString &error) { emit loginFailed(error); });
 }
 
-QString ControlPlaneClient::normalizeBaseUrl(const QString &value) const {
-    QString trimmed = value.trimmed();
-    if (trimmed.isEmpty()) {
-        return trimmed;
-    }
-    if (!trimmed.startsWith("http://") && !trimmed.startsWith("https://")) {
-        trimmed.prepend("http://");
-    }
-    while (trimmed.endsWith('/')) {
-        trimmed.chop(1);
-    }
-    return trimmed;
-}
-
-QUrl ControlPlaneClient::makeUrl(const QString &path) const {
-    const QUrl base(normalizeBaseUrl(m_baseUrl));
-    QUrl relative(path.startsWith('/') ? path : QString("/%1").arg(path));
-    return base.resolved(relative);
-}
-
 void ControlPlaneClient::sendRequest(
     const QString &method,
     const QString &path,
@@ -129,20 +114,9 @@ void ControlPlaneClient::sendRequest(
         return;
     }
 
-    QNetworkRequest request(makeUrl(path));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    if (!m_authToken.isEmpty()) {
-        request.setRawHeader("Authorization", QByteArray("Bearer ") + m_authToken.toUtf8());
-    }
-
-    QNetworkReply *reply = nullptr;
-    if (method == "GET") {
-        reply = m_manager.get(request);
-    } else if (method == "POST") {
-        reply = m_manager.post(request, QJsonDocument(body).toJson());
-    } else {
-        reply = m_manager.sendCustomRequest(request, method.toUtf8(), QJsonDocument(body).toJson());
-    }
+    const QNetworkRequest request = HttpCore::makeRequest(HttpCore::makeUrl(m_baseUrl, path), m_authToken);
+    const QByteArray requestBody = method == "GET" ? QByteArray() : QJsonDocument(body).toJson();
+    QNetworkReply *reply = m_http->send(method, request, requestBody, "registry");
 
     connect(reply, &QNetworkReply::finished, this, [this, reply, path, onSuccess, onError]() {
         const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
@@ -150,9 +124,7 @@ void ControlPlaneClient::sendRequest(
         const bool okStatus = status >= 200 && status < 300;
 
         if (reply->error() != QNetworkReply::NoError || !okStatus) {
-            const QString detail = payload.isEmpty()
-                ? reply->errorString()
-                : QString::fromUtf8(payload);
+            const QString detail = HttpCore::errorDetail(reply, payload);
             if (status == 401 && !path.startsWith("/api/v1/auth/")) {
                 setAuthToken(QString());
                 setAccessTokenExpiresAt(QString());
@@ -171,19 +143,21 @@ void ControlPlaneClient::sendRequest(
             return;
         }
 
-        QJsonParseError parseError;
-        const QJsonDocument doc = QJsonDocument::fromJson(payload, &parseError);
-        if (parseError.error != QJsonParseError::NoError) {
-            const QString detail = QString("Invalid JSON: %1").arg(parseError.errorString());
-            if (onError) {
-                onError(detail);
-            }
-            emit requestFailed(path, detail);
-            reply->deleteLater();
-            return;
-        }
-
-        onSuccess(doc);
         reply->deleteLater();
+        QtConcurrent::run([payload]() {
+            QJsonParseError parseError;
+            const QJsonDocument doc = QJsonDocument::fromJson(payload, &parseError);
+            return std::make_pair(doc, parseError);
+        }).then(this, [this, path, onSuccess, onError](const std::pair<QJsonDocument, QJsonParseError> &parsed) {
+            if (parsed.second.error != QJsonParseError::NoError) {
+                const QString detail = QString("Invalid JSON: %1").arg(parsed.second.errorString());
+                if (onError) {
+                    onError(detail);
+                }
+                emit requestFailed(path, detail);
+                return;
+            }
+            onSuccess(parsed.first);
+        });
     });
 }
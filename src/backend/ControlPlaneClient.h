@@ -1,11 +1,10 @@
 #pragma once
 
 #include <QObject>
-#include <QNetworkAccessManager>
 #include <QJsonObject>
-#include <QUrl>
 #include <functional>
 
+class HttpCore;
 class QJsonDocument;
 
 class ControlPlaneClient : public QObject {
@@ -15,7 +14,7 @@ class ControlPlaneClient : public QObject {
     Q_PROPERTY(QString accessTokenExpiresAt READ accessTokenExpiresAt WRITE setAccessTokenExpiresAt NOTIFY accessTokenExpiresAtChanged)
 
 public:
-    explicit ControlPlaneClient(QObject *parent = nullptr);
+    explicit ControlPlaneClient(HttpCore *http, QObject *parent = nullptr);
 
     QString baseUrl() const;
     void setBaseUrl(const QString &value);
@@ -43,8 +42,6 @@ private:
     using SuccessHandler = std::function<void(const QJsonDocument &)>;
     using ErrorHandler = std::function<void(const QString &)>;
 
-    QString normalizeBaseUrl(const QString &value) const;
-    QUrl makeUrl(const QString &path) const;
     void sendRequest(
         const QString &method,
         const QString &path,
@@ -52,7 +49,7 @@ private:
         const SuccessHandler &onSuccess,
         const ErrorHandler &onError = ErrorHandler());
 
-    QNetworkAccessManager m_manager;
+    HttpCore *m_http = nullptr;
     QString m_baseUrl;
     QString m_authToken;
     QString m_accessTokenExpiresAt;
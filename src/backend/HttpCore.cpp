@@ -0,0 +1,203 @@
+#include "backend/HttpCore.h"
+
+#include "backend/Logging.h"
+
+#include <QElapsedTimer>
+#include <QNetworkReply>
+#include <memory>
+#if QT_CONFIG(ssl)
+#include <QSslConfiguration>
+#endif
+
+namespace {
+// Matches QNetworkAccessManager's own HTTP/1.1 connection limit per host.
+constexpr int kHostBudget = 6;
+constexpr qint64 kPreconnectIntervalMs = 10000;
+// An h2c request dropped this many times in a row without a response means
+// the host does not speak it, even without a protocol error.
+constexpr int kCleartextHttp2MaxDrops = 3;
+
+// Errors an HTTP/1.1-only peer produces when it is sent an h2c preface.
+bool isProtocolRejection(QNetworkReply::NetworkError error) {
+    return error == QNetworkReply::ProtocolFailure || error == QNetworkReply::ProtocolUnknownError;
+}
+
+// Errors that an h2c rejection can look like, but so can a flaky network.
+bool isDroppedConnection(QNetworkReply::NetworkError error) {
+    return error == QNetworkReply::RemoteHostClosedError || error == QNetworkReply::UnknownNetworkError;
+}
+
+#if QT_CONFIG(ssl)
+// Used for every request and preconnect rather than changing the process
+// default. Identical settings let requests reuse the preconnected socket.
+QSslConfiguration tlsConfiguration() {
+    QSslConfiguration ssl = QSslConfiguration::defaultConfiguration();
+    ssl.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    ssl.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2, QSslConfiguration::NextProtocolHttp1_1});
+    return ssl;
+}
+#endif
+} // namespace
+
+HttpCore::HttpCore(QObject *parent)
+    : QObject(parent) {}
+
+QString HttpCore::normalizeBaseUrl(const QString &value) {
+    QString trimmed = value.trimmed();
+    if (trimmed.isEmpty()) {
+        return trimmed;
+    }
+    if (!trimmed.startsWith("http://") && !trimmed.startsWith("https://")) {
+        trimmed.prepend("http://");
+    }
+    while (trimmed.endsWith('/')) {
+        trimmed.chop(1);
+    }
+    return trimmed;
+}
+
+QUrl HttpCore::makeUrl(const QString &baseUrl, const QString &path) {
+    const QUrl base(normalizeBaseUrl(baseUrl));
+    QUrl relative(path.startsWith('/') ? path : QString("/%1").arg(path));
+    return base.resolved(relative);
+}
+
+QNetworkRequest HttpCore::makeRequest(const QUrl &url, const QString &authToken) {
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+#if QT_CONFIG(ssl)
+    if (url.scheme() == "https") {
+        request.setSslConfiguration(tlsConfiguration());
+    }
+#endif
+    if (!authToken.isEmpty()) {
+        request.setRawHeader("Authorization", QByteArray("Bearer ") + authToken.toUtf8());
+    }
+    return request;
+}
+
+QString HttpCore::errorDetail(QNetworkReply *reply, const QByteArray &payload) {
+    return payload.isEmpty() ? reply->errorString() : QString::fromUtf8(payload);
+}
+
+void HttpCore::preconnect(const QUrl &url) {
+    if (!url.isValid() || url.host().isEmpty()) {
+        return;
+    }
+    const QString host = hostKey(url);
+    auto last = m_preconnects.find(host);
+    if (last != m_preconnects.end() && last->elapsed() < kPreconnectIntervalMs) {
+        return;
+    }
+    m_preconnects[host].start();
+
+    if (url.scheme() == "https") {
+#if QT_CONFIG(ssl)
+        m_manager.connectToHostEncrypted(url.host(), static_cast<quint16>(url.port(443)), tlsConfiguration());
+#endif
+        return;
+    }
+    m_manager.connectToHost(url.host(), static_cast<quint16>(url.port(80)));
+}
+
+QNetworkReply *HttpCore::send(
+    const QString &method,
+    const QNetworkRequest &request,
+    const QByteArray &body,
+    const QString &route) {
+    const QString host = hostKey(request.url());
+    QNetworkRequest outgoing = request;
+    const bool cleartextHttp2 = m_cleartextHttp2 && request.url().scheme() == "http"
+        && !m_cleartextHttp2Failed.contains(host);
+    if (cleartextHttp2) {
+        outgoing.setAttribute(QNetworkRequest::Http2CleartextAllowedAttribute, true);
+    }
+
+    QNetworkReply *reply = nullptr;
+    if (method == "GET") {
+        reply = m_manager.get(outgoing);
+    } else if (method == "POST") {
+        reply = m_manager.post(outgoing, body);
+    } else {
+        reply = m_manager.sendCustomRequest(outgoing, method.toUtf8(), body);
+    }
+
+    auto timer = std::make_shared<QElapsedTimer>();
+    auto timings = std::make_shared<NetworkMetrics::Timings>();
+    auto newConnection = std::make_shared<bool>(false);
+    timer->start();
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [newConnection]() {
+        *newConnection = true;
+    });
+    connect(reply, &QNetworkReply::requestSent, this, [timer, timings, newConnection]() {
+        if (*newConnection && timings->connectMs < 0) {
+            timings->connectMs = timer->elapsed();
+        }
+    });
+    connect(reply, &QNetworkReply::metaDataChanged, this, [timer, timings]() {
+        if (timings->ttfbMs < 0) {
+            timings->ttfbMs = timer->elapsed();
+        }
+    });
+    connect(reply, &QNetworkReply::downloadProgress, this, [timings](qint64 received, qint64) {
+        timings->bytes = received;
+    });
+
+    const QString endpoint = NetworkMetrics::endpointTemplate(method, request.url());
+    ++m_hostInFlight[host];
+    connect(reply, &QNetworkReply::finished, this, [this, reply, host, endpoint, route, timer, timings, cleartextHttp2]() {
+        auto it = m_hostInFlight.find(host);
+        if (it != m_hostInFlight.end() && --it.value() <= 0) {
+            m_hostInFlight.erase(it);
+        }
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (cleartextHttp2 && !m_cleartextHttp2Failed.contains(host)) {
+            bool rejected = false;
+            if (status != 0) {
+                m_cleartextHttp2Drops.remove(host);
+            } else if (isProtocolRejection(reply->error())) {
+                rejected = true;
+            } else if (isDroppedConnection(reply->error())) {
+                rejected = ++m_cleartextHttp2Drops[host] >= kCleartextHttp2MaxDrops;
+            }
+            if (rejected) {
+                qCWarning(lcApi) << "h2c rejected by" << host << reply->errorString() << "- using HTTP/1.1";
+                m_cleartextHttp2Failed.insert(host);
+                m_cleartextHttp2Drops.remove(host);
+            }
+        }
+        timings->totalMs = timer->elapsed();
+        timings->error = reply->error() != QNetworkReply::NoError || status >= 400;
+        m_metrics.recordRequest(endpoint, route, *timings);
+        emit hostCapacityAvailable(host);
+    });
+    return reply;
+}
+
+NetworkMetrics *HttpCore::metrics() {
+    return &m_metrics;
+}
+
+bool HttpCore::cleartextHttp2Allowed() const {
+    return m_cleartextHttp2;
+}
+
+void HttpCore::setCleartextHttp2Allowed(bool allowed) {
+    m_cleartextHttp2 = allowed;
+    m_cleartextHttp2Failed.clear();
+    m_cleartextHttp2Drops.clear();
+}
+
+int HttpCore::inFlight(const QUrl &url) const {
+    return m_hostInFlight.value(hostKey(url));
+}
+
+bool HttpCore::hasCapacity(const QUrl &url, int reserved) const {
+    return inFlight(url) + reserved < kHostBudget;
+}
+
+QString HttpCore::hostKey(const QUrl &url) {
+    const int defaultPort = url.scheme() == "https" ? 443 : 80;
+    return QString("%1://%2:%3").arg(url.scheme(), url.host()).arg(url.port(defaultPort));
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QString>
+#include <QUrl>
+
+#include "backend/NetworkMetrics.h"
+
+class QNetworkReply;
+
+// One connection pool, DNS cache and TLS session cache shared by every
+// client that talks HTTP, with per-host in-flight accounting.
+class HttpCore : public QObject {
+    Q_OBJECT
+
+public:
+    explicit HttpCore(QObject *parent = nullptr);
+
+    static QString normalizeBaseUrl(const QString &value);
+    static QUrl makeUrl(const QString &baseUrl, const QString &path);
+    static QNetworkRequest makeRequest(const QUrl &url, const QString &authToken = QString());
+    static QString errorDetail(QNetworkReply *reply, const QByteArray &payload);
+
+    void preconnect(const QUrl &url);
+    QNetworkReply *send(
+        const QString &method,
+        const QNetworkRequest &request,
+        const QByteArray &body = QByteArray(),
+        const QString &route = QString());
+
+    NetworkMetrics *metrics();
+
+    // Lets plain http:// requests use HTTP/2 with prior knowledge. Off by
+    // default: servers or proxies that only speak HTTP/1.1 reject it, and a
+    // host that does is sent HTTP/1.1 from then on. A protocol error counts
+    // as a rejection at once; dropped connections only after several in a row.
+    bool cleartextHttp2Allowed() const;
+    void setCleartextHttp2Allowed(bool allowed);
+
+    int inFlight(const QUrl &url) const;
+    bool hasCapacity(const QUrl &url, int reserved = 0) const;
+
+signals:
+    void hostCapacityAvailable(const QString &host);
+
+private:
+    static QString hostKey(const QUrl &url);
+
+    QNetworkAccessManager m_manager;
+    NetworkMetrics m_metrics;
+    QHash<QString, int> m_hostInFlight;
+    QHash<QString, QElapsedTimer> m_preconnects;
+    bool m_cleartextHttp2 = false;
+    QSet<QString> m_cleartextHttp2Failed;
+    QHash<QString, int> m_cleartextHttp2Drops;
+};
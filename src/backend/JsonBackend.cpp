@@ -0,0 +1,91 @@
+#include "backend/JsonBackend.h"
+
+#ifdef ELIXIR_HAS_SIMDJSON
+#include "backend/Logging.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <simdjson.h>
+
+namespace {
+QString toQString(std::string_view value) {
+    return QString::fromUtf8(value.data(), static_cast<qsizetype>(value.size()));
+}
+
+QJsonValue toJsonValue(simdjson::dom::element element) {
+    switch (element.type()) {
+        case simdjson::dom::element_type::ARRAY: {
+            QJsonArray array;
+            for (simdjson::dom::element child : element.get_array().value_unsafe()) {
+                array.append(toJsonValue(child));
+            }
+            return array;
+        }
+        case simdjson::dom::element_type::OBJECT: {
+            QJsonObject object;
+            for (simdjson::dom::key_value_pair field : element.get_object().value_unsafe()) {
+                object.insert(toQString(field.key), toJsonValue(field.value));
+            }
+            return object;
+        }
+        case simdjson::dom::element_type::STRING:
+            return toQString(element.get_string().value_unsafe());
+        case simdjson::dom::element_type::INT64:
+            return static_cast<qint64>(element.get_int64().value_unsafe());
+        case simdjson::dom::element_type::UINT64:
+            return static_cast<double>(element.get_uint64().value_unsafe());
+        case simdjson::dom::element_type::DOUBLE:
+            return element.get_double().value_unsafe();
+        case simdjson::dom::element_type::BOOL:
+            return element.get_bool().value_unsafe();
+        case simdjson::dom::element_type::NULL_VALUE:
+            return QJsonValue(QJsonValue::Null);
+    }
+    return QJsonValue();
+}
+
+simdjson::dom::parser &threadParser() {
+    // One parser per thread keeps its buffers warm across payloads.
+    thread_local simdjson::dom::parser parser;
+    return parser;
+}
+} // namespace
+#endif
+
+QString JsonBackend::name() {
+#ifdef ELIXIR_HAS_SIMDJSON
+    return QStringLiteral("simdjson");
+#else
+    return QStringLiteral("qt");
+#endif
+}
+
+QJsonDocument JsonBackend::parse(const QByteArray &json, QJsonParseError *error) {
+#ifdef ELIXIR_HAS_SIMDJSON
+    simdjson::dom::element root;
+    const auto code = threadParser().parse(json.constData(), static_cast<size_t>(json.size())).get(root);
+    if (!code && (root.is_array() || root.is_object())) {
+        if (error) {
+            error->error = QJsonParseError::NoError;
+            error->offset = 0;
+        }
+        const QJsonValue value = toJsonValue(root);
+        return value.isArray() ? QJsonDocument(value.toArray()) : QJsonDocument(value.toObject());
+    }
+    if (code) {
+        qCDebug(lcApi) << "simdjson rejected payload:" << simdjson::error_message(code);
+    }
+#endif
+    return QJsonDocument::fromJson(json, error);
+}
+
+#ifdef ELIXIR_HAS_SIMDJSON
+bool JsonBackend::parseDom(const QByteArray &json, simdjson::dom::element *root) {
+    const auto code = threadParser().parse(json.constData(), static_cast<size_t>(json.size())).get(*root);
+    if (code) {
+        qCDebug(lcApi) << "simdjson rejected payload:" << simdjson::error_message(code);
+    }
+    return !code;
+}
+#endif
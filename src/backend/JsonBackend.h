@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QString>
+
+#ifdef ELIXIR_HAS_SIMDJSON
+#include <simdjson.h>
+#endif
+
+// Parses API payloads with simdjson when the build enables it
+// (ELIXIR_USE_SIMDJSON), otherwise with QJsonDocument.
+namespace JsonBackend {
+    QString name();
+    QJsonDocument parse(const QByteArray &json, QJsonParseError *error = nullptr);
+#ifdef ELIXIR_HAS_SIMDJSON
+    // Parses into the calling thread's parser without building a QJson tree.
+    // The element stays valid until that thread parses again.
+    bool parseDom(const QByteArray &json, simdjson::dom::element *root);
+#endif
+}
@@ -1,110 +1,282 @@
 #include "backend/LibraryModel.h"
 
+#include "backend/LibrarySnapshot.h"
+#include "backend/Logging.h"
+#include "backend/MediaItemParser.h"
+#include "backend/TraceRecorder.h"
+
+#include <QCollator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
 #include <QJsonValue>
-#include <QMetaType>
-#include <QUrl>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <numeric>
+#include <utility>
 
-MediaFilterModel::MediaFilterModel(QObject *parent)
-    : QSortFilterProxyModel(parent) {
-    setDynamicSortFilter(true);
-    setSortCaseSensitivity(Qt::CaseInsensitive);
-    setSortLocaleAware(true);
+namespace {
+// Beyond this many row operations a reset is cheaper than the diff.
+constexpr qint64 kDiffWorkBudget = 4000000;
+constexpr int kRankedSearchLimit = 200;
+constexpr int kSearchDebounceMs = 120;
+// While a stream is filling the library, views catch up at most once a frame,
+// and less often when an update is slow enough that doing it per frame would
+// take more than a fifth of the GUI thread.
+constexpr int kStreamViewMinIntervalMs = 16;
+constexpr int kStreamViewMaxIntervalMs = 500;
 
-    auto emitCountChanged = [this]() { emit countChanged(); };
-    connect(this, &QAbstractItemModel::rowsInserted, this, emitCountChanged);
-    connect(this, &QAbstractItemModel::rowsRemoved, this, emitCountChanged);
-    connect(this, &QAbstractItemModel::modelReset, this, emitCountChanged);
-    connect(this, &QAbstractItemModel::layoutChanged, this, emitCountChanged);
+QVector<MediaItem> buildItems(const QVariantList &items, const QString &baseUrl) {
+    QVector<MediaItem> built;
+    built.reserve(items.size());
+    for (const QVariant &value : items) {
+        const QVariantMap map = value.toMap();
+        if (!map.isEmpty()) {
+            built.push_back(MediaItemParser::fromJson(QJsonObject::fromVariantMap(map), baseUrl));
+        }
+    }
+    return built;
 }
 
-QString MediaFilterModel::typeFilter() const {
-    return m_typeFilter;
+QVector<MediaItem> buildItems(const QJsonArray &items, const QString &baseUrl) {
+    QVector<MediaItem> built;
+    built.reserve(items.size());
+    for (const QJsonValue &value : items) {
+        if (!value.isObject()) {
+            continue;
+        }
+        MediaItem item = MediaItemParser::fromJson(value.toObject(), baseUrl);
+        if (!item.id.isEmpty()) {
+            built.push_back(std::move(item));
+        }
+    }
+    return built;
 }
 
-void MediaFilterModel::setTypeFilter(const QString &value) {
-    if (m_typeFilter == value) {
-        return;
+QVector<MediaItem> buildItems(const QByteArrayList &items, const QString &baseUrl) {
+    QVector<MediaItem> built;
+    built.reserve(items.size());
+    for (const QByteArray &json : items) {
+        bool ok = false;
+        MediaItem item = MediaItemParser::fromJson(json, baseUrl, &ok);
+        if (ok && !item.id.isEmpty()) {
+            built.push_back(std::move(item));
+        }
+    }
+    return built;
+}
+QVector<int> changedRoles(LibraryStore::Fields fields) {
+    static const std::array<std::pair<LibraryStore::Field, int>, 10> kFieldRoles{{
+        {LibraryStore::TitleField, MediaRoles::TitleRole},
+        {LibraryStore::TypeField, MediaRoles::TypeRole},
+        {LibraryStore::YearField, MediaRoles::YearRole},
+        {LibraryStore::PosterField, MediaRoles::PosterRole},
+        {LibraryStore::BackdropField, MediaRoles::BackdropRole},
+        {LibraryStore::OverviewField, MediaRoles::OverviewRole},
+        {LibraryStore::GenresField, MediaRoles::GenresRole},
+        {LibraryStore::ProgressField, MediaRoles::ProgressRole},
+        {LibraryStore::RuntimeField, MediaRoles::RuntimeRole},
+        {LibraryStore::UpdatedField, MediaRoles::UpdatedAtRole},
+    }};
+    QVector<int> roles;
+    for (const auto &[field, role] : kFieldRoles) {
+        if (fields.testFlag(field)) {
+            roles.append(role);
+        }
     }
-    m_typeFilter = value;
-    invalidateFilter();
-    emit typeFilterChanged();
+    return roles;
 }
 
-QString MediaFilterModel::searchQuery() const {
-    return m_searchQuery;
+// Maps signed values onto unsigned keys in the same order.
+quint64 orderedKey(qint64 value) {
+    return static_cast<quint64>(value) ^ (quint64(1) << 63);
 }
 
-void MediaFilterModel::setSearchQuery(const QString &value) {
-    if (m_searchQuery == value) {
-        return;
+// Stable LSD radix sort of rows by their key, skipping bytes every key shares.
+void radixSort(QVector<int> *order, const QVector<quint64> &keys) {
+    QVector<int> buffer(order->size());
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::array<int, 256> offsets{};
+        for (const int row : std::as_const(*order)) {
+            ++offsets[(keys.at(row) >> shift) & 0xff];
+        }
+        if (std::find(offsets.cbegin(), offsets.cend(), order->size()) != offsets.cend()) {
+            continue;
+        }
+        int total = 0;
+        for (int &offset : offsets) {
+            const int count = offset;
+            offset = total;
+            total += count;
+        }
+        for (const int row : std::as_const(*order)) {
+            buffer[offsets[(keys.at(row) >> shift) & 0xff]++] = row;
+        }
+        order->swap(buffer);
     }
-    m_searchQuery = value;
-    invalidateFilter();
-    emit searchQueryChanged();
 }
 
-bool MediaFilterModel::requireProgress() const {
-    return m_requireProgress;
+// Marks one longest increasing subsequence of values. Those entries keep
+// their relative order; only the others have to move.
+QVector<bool> longestIncreasingRun(const QVector<int> &values) {
+    QVector<int> tails;
+    QVector<int> previous(values.size(), -1);
+    for (int i = 0; i < values.size(); ++i) {
+        const auto it = std::lower_bound(tails.begin(), tails.end(), values.at(i), [&values](int index, int value) {
+            return values.at(index) < value;
+        });
+        if (it != tails.begin()) {
+            previous[i] = *(it - 1);
+        }
+        if (it == tails.end()) {
+            tails.append(i);
+        } else {
+            *it = i;
+        }
+    }
+    QVector<bool> inRun(values.size(), false);
+    for (int i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = previous.at(i)) {
+        inRun[i] = true;
+    }
+    return inRun;
+}
+
+// Timestamps carry arbitrary UTC offsets, so they are ordered by the parsed
+// time; the text only breaks ties, such as between unparsable values.
+bool isNewerThan(const MediaItem &item, qint64 cursorMs, const QString &cursor) {
+    return item.updatedAtMs != cursorMs ? item.updatedAtMs > cursorMs : item.updatedAt > cursor;
 }
+} // namespace
 
-void MediaFilterModel::setRequireProgress(bool value) {
-    if (m_requireProgress == value) {
-        return;
+MediaViewModel::MediaViewModel(LibraryModel *source, QObject *parent)
+    : QAbstractListModel(parent),
+      m_source(source) {}
+
+int MediaViewModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) {
+        return 0;
     }
-    m_requireProgress = value;
-    invalidateFilter();
-    emit requireProgressChanged();
+    return m_rows.size();
 }
 
-int MediaFilterModel::count() const {
-    return rowCount();
+QVariant MediaViewModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+    return m_source->data(m_source->index(m_rows.at(index.row())), role);
 }
 
-bool MediaFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
-    const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-    if (!m_typeFilter.isEmpty()) {
-        const QString type = sourceModel()->data(index, MediaRoles::TypeRole).toString();
-        if (type != m_typeFilter) {
-            return false;
-        }
+QHash<int, QByteArray> MediaViewModel::roleNames() const {
+    return m_source->roleNames();
+}
+
+int MediaViewModel::count() const {
+    return m_rows.size();
+}
+
+void MediaViewModel::setRows(const QVector<int> &rows, const QStringList &ids, const QSet<QString> &changedIds) {
+    const int previousCount = m_ids.size();
+    const int common = qMin(m_ids.size(), ids.size());
+    int prefix = 0;
+    while (prefix < common && m_ids.at(prefix) == ids.at(prefix)) {
+        ++prefix;
     }
-    if (!m_searchQuery.trimmed().isEmpty()) {
-        const QString query = m_searchQuery.trimmed();
-        const QString title = sourceModel()->data(index, MediaRoles::TitleRole).toString();
-        const QString overview = sourceModel()->data(index, MediaRoles::OverviewRole).toString();
-        if (!title.contains(query, Qt::CaseInsensitive) &&
-            !overview.contains(query, Qt::CaseInsensitive)) {
-            return false;
+    int suffix = 0;
+    while (suffix < common - prefix && m_ids.at(m_ids.size() - 1 - suffix) == ids.at(ids.size() - 1 - suffix)) {
+        ++suffix;
+    }
+    const int oldEnd = m_ids.size() - suffix;
+    const int newEnd = ids.size() - suffix;
+    const int oldSpan = oldEnd - prefix;
+    const int newSpan = newEnd - prefix;
+
+    // One item moving to the front or back (e.g. a freshly updated item in
+    // "recent" order) is a move, not a remove and insert of the span.
+    const bool movedUp = oldSpan > 1 && oldSpan == newSpan && ids.at(prefix) == m_ids.at(oldEnd - 1)
+        && std::equal(m_ids.cbegin() + prefix, m_ids.cbegin() + oldEnd - 1, ids.cbegin() + prefix + 1);
+    const bool movedDown = !movedUp && oldSpan > 1 && oldSpan == newSpan && ids.at(newEnd - 1) == m_ids.at(prefix)
+        && std::equal(m_ids.cbegin() + prefix + 1, m_ids.cbegin() + oldEnd, ids.cbegin() + prefix);
+    if (movedUp) {
+        beginMoveRows(QModelIndex(), oldEnd - 1, oldEnd - 1, QModelIndex(), prefix);
+        m_rows = rows;
+        m_ids = ids;
+        endMoveRows();
+    } else if (movedDown) {
+        beginMoveRows(QModelIndex(), prefix, prefix, QModelIndex(), oldEnd);
+        m_rows = rows;
+        m_ids = ids;
+        endMoveRows();
+    } else {
+        if (oldSpan > 0) {
+            beginRemoveRows(QModelIndex(), prefix, oldEnd - 1);
+            m_rows = rows.mid(0, prefix) + rows.mid(newEnd);
+            m_ids = ids.mid(0, prefix) + ids.mid(newEnd);
+            endRemoveRows();
+        }
+        if (newSpan > 0) {
+            beginInsertRows(QModelIndex(), prefix, newEnd - 1);
+            m_rows = rows;
+            m_ids = ids;
+            endInsertRows();
         }
     }
-    if (m_requireProgress) {
-        const double progress = sourceModel()->data(index, MediaRoles::ProgressRole).toDouble();
-        if (progress <= 0.0) {
-            return false;
+    // Source rows shift on removal even when this view's order is unchanged.
+    m_rows = rows;
+    m_ids = ids;
+
+    if (!changedIds.isEmpty()) {
+        for (int row = 0; row < m_ids.size(); ++row) {
+            if (changedIds.contains(m_ids.at(row))) {
+                emit dataChanged(index(row), index(row));
+            }
         }
     }
-    return true;
+    if (m_ids.size() != previousCount) {
+        emit countChanged();
+    }
 }
 
-LibraryModel::LibraryModel(QObject *parent)
-    : QAbstractListModel(parent) {
-    m_allModel.setSourceModel(this);
+void MediaViewModel::resetRows(const QVector<int> &rows, const QStringList &ids) {
+    beginResetModel();
+    m_rows = rows;
+    m_ids = ids;
+    endResetModel();
+    emit countChanged();
+}
 
-    m_moviesModel.setSourceModel(this);
-    m_moviesModel.setTypeFilter("movie");
+LibraryModel::LibraryModel(QObject *parent)
+    : QAbstractListModel(parent),
+      m_allModel(this),
+      m_moviesModel(this),
+      m_seriesModel(this),
+      m_animeModel(this),
+      m_continueModel(this),
+      m_searchModel(this),
+      m_rankedSearchModel(this) {
+    applyFilterMode();
 
-    m_seriesModel.setSourceModel(this);
-    m_seriesModel.setTypeFilter("series");
+    // A single builder thread keeps batches in arrival order.
+    m_buildPool.setMaxThreadCount(1);
 
-    m_animeModel.setSourceModel(this);
-    m_animeModel.setTypeFilter("anime");
+    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
 
-    m_continueModel.setSourceModel(this);
-    m_continueModel.setRequireProgress(true);
+    // Queries run one at a time; a superseded one finishes quickly.
+    m_searchPool.setMaxThreadCount(1);
+    m_searchTimer.setSingleShot(true);
+    m_searchTimer.setInterval(kSearchDebounceMs);
+    connect(&m_searchTimer, &QTimer::timeout, this, &LibraryModel::runSearch);
 
-    m_searchModel.setSourceModel(this);
-    applySortMode();
-    applyFilterMode();
+    m_streamViewTimer.setSingleShot(true);
+    m_streamViewTimer.setInterval(kStreamViewMinIntervalMs);
+    connect(&m_streamViewTimer, &QTimer::timeout, this, [this]() {
+        QElapsedTimer elapsed;
+        elapsed.start();
+        updateViews(false);
+        m_streamViewTimer.setInterval(
+            std::clamp(int(elapsed.elapsed() * 4), kStreamViewMinIntervalMs, kStreamViewMaxIntervalMs));
+    });
 }
 
 int LibraryModel::rowCount(const QModelIndex &parent) const {
@@ -118,30 +290,30 @@ QVariant LibraryModel::data(const QModelIndex &index, int role) const {
     if (!index.isValid() || index.row() < 0 || index.row() >= m_items.size()) {
         return QVariant();
     }
-    const MediaItem &item = m_items.at(index.row());
+    const int row = index.row();
     switch (role) {
         case MediaRoles::IdRole:
-            return item.id;
+            return m_items.id(row);
         case MediaRoles::TitleRole:
-            return item.title;
+            return m_items.title(row);
         case MediaRoles::TypeRole:
-            return item.type;
+            return m_items.type(row);
         case MediaRoles::YearRole:
-            return item.year;
+            return m_items.year(row);
         case MediaRoles::PosterRole:
-            return item.posterUrl;
+            return m_items.posterUrl(row);
         case MediaRoles::BackdropRole:
-            return item.backdropUrl;
+            return m_items.backdropUrl(row);
         case MediaRoles::OverviewRole:
-            return item.overview;
+            return m_items.overview(row);
         case MediaRoles::GenresRole:
-            return item.genres;
+            return m_items.genres(row);
         case MediaRoles::ProgressRole:
-            return item.progress;
+            return m_items.progress(row);
         case MediaRoles::RuntimeRole:
-            return item.runtimeSeconds;
+            return m_items.runtimeSeconds(row);
         case MediaRoles::UpdatedAtRole:
-            return item.updatedAt;
+            return m_items.updatedAt(row);
         default:
             return QVariant();
     }
@@ -171,7 +343,7 @@ QVariantMap LibraryModel::get(int index) const {
     if (index < 0 || index >= m_items.size()) {
         return QVariantMap();
     }
-    const MediaItem &item = m_items.at(index);
+    const MediaItem item = m_items.at(index);
     return {
         {"mediaId", item.id},
         {"title", item.title},
@@ -188,12 +360,20 @@ QVariantMap LibraryModel::get(int index) const {
 }
 
 int LibraryModel::indexOfId(const QString &id) const {
-    for (int i = 0; i < m_items.size(); ++i) {
-        if (m_items.at(i).id == id) {
-            return i;
+    if (!m_rowIndexValid) {
+        m_rowById.clear();
+        m_rowById.reserve(m_items.size());
+        for (int i = m_items.size() - 1; i >= 0; --i) {
+            m_rowById.insert(m_items.id(i), i);
         }
+        m_rowIndexValid = true;
     }
-    return -1;
+    return m_rowById.value(id, -1);
+}
+
+LibraryItem LibraryModel::itemById(const QString &id) const {
+    const int row = indexOfId(id);
+    return row >= 0 ? LibraryItem(m_items.at(row)) : LibraryItem();
 }
 
 QAbstractItemModel *LibraryModel::allModel() {
@@ -220,6 +400,10 @@ QAbstractItemModel *LibraryModel::searchModel() {
     return &m_searchModel;
 }
 
+QAbstractItemModel *LibraryModel::rankedSearchModel() {
+    return &m_rankedSearchModel;
+}
+
 QString LibraryModel::searchQuery() const {
     return m_searchQuery;
 }
@@ -243,9 +427,55 @@ void LibraryModel::setBaseUrl(const QString &value) {
         return;
     }
     m_baseUrl = trimmed;
+    resetLibrary();
     emit baseUrlChanged();
 }
 
+QString LibraryModel::accountId() const {
+    return m_accountId;
+}
+
+void LibraryModel::setAccountId(const QString &value) {
+    if (m_accountId == value) {
+        return;
+    }
+    // The previous account signed out or was replaced, so its snapshot goes.
+    // Removal queues behind any save still on the build thread.
+    const QString previousSnapshot = LibrarySnapshot::pathFor(m_baseUrl, m_accountId);
+    if (!previousSnapshot.isEmpty()) {
+        QtConcurrent::run(&m_buildPool, [previousSnapshot]() {
+            QFile::remove(previousSnapshot);
+        });
+    }
+    m_accountId = value;
+    resetLibrary();
+    emit accountIdChanged();
+}
+
+void LibraryModel::resetLibrary() {
+    TraceSpan span("reset library", "library");
+    ++m_libraryGeneration;
+    abortLibraryStream();
+    const bool hadItems = !m_items.isEmpty();
+    beginResetModel();
+    m_items.clear();
+    m_sortOrderValid = false;
+    m_rowIndexValid = false;
+    m_searchIndexValid = false;
+    m_searchIndex.reset();
+    m_titleSortKeys.clear();
+    endResetModel();
+    updateViews(true);
+    if (hadItems) {
+        emit countChanged();
+    }
+    m_syncCursorMs = 0;
+    if (!m_syncCursor.isEmpty()) {
+        m_syncCursor.clear();
+        emit syncCursorChanged();
+    }
+}
+
 QString LibraryModel::sortMode() const {
     return m_sortMode;
 }
@@ -274,278 +504,691 @@ void LibraryModel::setFilterMode(const QString &value) {
     emit filterModeChanged();
 }
 
+QString LibraryModel::syncCursor() const {
+    return m_syncCursor;
+}
+
+bool LibraryModel::loadSnapshot() {
+    TraceSpan span("load snapshot", "library");
+    QVector<MediaItem> items;
+    const QString path = LibrarySnapshot::pathFor(m_baseUrl, m_accountId);
+    if (!LibrarySnapshot::read(path, m_baseUrl, m_accountId, &items)) {
+        return false;
+    }
+    replaceItems(std::move(items));
+    return true;
+}
+
+void LibraryModel::saveSnapshot() {
+    const QString path = LibrarySnapshot::pathFor(m_baseUrl, m_accountId);
+    if (path.isEmpty()) {
+        return;
+    }
+    QtConcurrent::run(&m_buildPool, [store = m_items, baseUrl = m_baseUrl, accountId = m_accountId, path]() {
+        TraceSpan span("save snapshot", "library");
+        LibrarySnapshot::write(path, baseUrl, accountId, store.toItems());
+    });
+}
+
 void LibraryModel::setItems(const QVariantList &items) {
-    beginResetModel();
-    m_items.clear();
-    m_items.reserve(items.size());
-    for (const QVariant &value : items) {
-        const QVariantMap map = value.toMap();
-        if (!map.isEmpty()) {
-            m_items.push_back(itemFromVariant(map));
+    const quint64 generation = m_libraryGeneration;
+    QtConcurrent::run(&m_buildPool, [items, baseUrl = m_baseUrl]() {
+        TraceSpan span("build items", "library");
+        return buildItems(items, baseUrl);
+    }).then(this, [this, generation](QVector<MediaItem> built) {
+        if (generation != m_libraryGeneration) {
+            return;
         }
-    }
-    endResetModel();
-    emit countChanged();
+        replaceItems(std::move(built));
+        saveSnapshot();
+    });
 }
 
-MediaItem LibraryModel::itemFromVariant(const QVariantMap &map) const {
-    MediaItem item;
-    item.id = map.value("id").toString();
-    item.title = map.value("title").toString();
-    item.type = map.value("type").toString();
-    item.year = map.value("year").toInt();
-    item.updatedAt = map.value("updated_at").toString();
-    item.runtimeSeconds = map.value("runtime_seconds").toInt();
-    item.progress = map.value("progress").toDouble();
+void LibraryModel::replaceLibrary(const QJsonArray &items) {
+    const quint64 generation = m_libraryGeneration;
+    QtConcurrent::run(&m_buildPool, [items, baseUrl = m_baseUrl]() {
+        TraceSpan span("build items", "library");
+        return buildItems(items, baseUrl);
+    }).then(this, [this, generation](QVector<MediaItem> built) {
+        if (generation != m_libraryGeneration) {
+            return;
+        }
+        replaceItems(std::move(built));
+        saveSnapshot();
+    });
+}
 
-    const QVariantMap metadata = map.value("metadata").toMap();
-    item.posterUrl = resolveUrl(map.value("poster_url").toString());
-    item.backdropUrl = resolveUrl(map.value("backdrop_url").toString());
-    const QString bannerUrl = resolveUrl(map.value("banner_url").toString());
-    if (item.title.trimmed().isEmpty()) {
-        item.title = extractTitle(metadata);
+void LibraryModel::replaceItems(QVector<MediaItem> items) {
+    QString cursor;
+    qint64 cursorMs = 0;
+    for (const MediaItem &item : items) {
+        if (isNewerThan(item, cursorMs, cursor)) {
+            cursor = item.updatedAt;
+            cursorMs = item.updatedAtMs;
+        }
     }
-    if (item.year <= 0) {
-        item.year = extractYear(metadata);
+    if (!diffItems(items)) {
+        TraceSpan span("reset items", "library");
+        beginResetModel();
+        m_items.assign(items);
+        m_sortOrderValid = false;
+        m_rowIndexValid = false;
+        m_searchIndexValid = false;
+        m_searchIndex.reset();
+        endResetModel();
+        updateViews(true);
+        emit countChanged();
+        if (!items.isEmpty()) {
+            qCInfo(lcApp) << "Library store holds" << items.size() << "items, estimated bytes per item"
+                          << m_items.bytesUsed() / items.size() << "compact vs"
+                          << LibraryStore::bytesUsed(items) / items.size() << "expanded";
+        }
     }
-    if (item.posterUrl.isEmpty()) {
-        item.posterUrl = resolveUrl(extractImage(metadata, {"poster", "posterUrl", "poster_url", "poster_path", "cover", "image"}));
+    m_syncCursorMs = cursorMs;
+    if (m_syncCursor != cursor) {
+        m_syncCursor = cursor;
+        emit syncCursorChanged();
     }
-    if (item.backdropUrl.isEmpty()) {
-        item.backdropUrl = resolveUrl(extractImage(metadata, {"background", "backdrop", "fanart", "backdropUrl", "backdrop_path"}));
+}
+
+bool LibraryModel::diffItems(const QVector<MediaItem> &items) {
+    if (m_items.isEmpty() || items.isEmpty()) {
+        return false;
     }
-    if (item.backdropUrl.isEmpty() && !bannerUrl.isEmpty()) {
-        item.backdropUrl = bannerUrl;
+    TraceSpan span("diff items", "library");
+    QHash<QString, int> newRows;
+    newRows.reserve(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        newRows.insert(items.at(i).id, i);
     }
-    if (item.backdropUrl.isEmpty()) {
-        item.backdropUrl = item.posterUrl;
+    if (newRows.size() != items.size()) {
+        return false;
     }
-    item.overview = extractDescription(metadata);
-    if (item.overview.isEmpty()) {
-        item.overview = map.value("description").toString();
-        if (item.overview.isEmpty()) {
-            item.overview = map.value("summary").toString();
+
+    // Estimate the structural work first and fall back to a reset when a
+    // refresh reshuffles most of the library.
+    QVector<int> keptOrder;
+    keptOrder.reserve(m_items.size());
+    QSet<QString> keptIds;
+    for (int row = 0; row < m_items.size(); ++row) {
+        const auto it = newRows.constFind(m_items.id(row));
+        if (it != newRows.constEnd()) {
+            keptOrder.append(it.value());
+            keptIds.insert(m_items.id(row));
         }
     }
-    item.genres = extractGenres(map, metadata);
+    if (keptIds.size() != keptOrder.size()) {
+        return false;
+    }
+    const QVector<bool> inRun = longestIncreasingRun(keptOrder);
+    const qint64 removals = m_items.size() - keptOrder.size();
+    const qint64 inserts = items.size() - keptOrder.size();
+    const qint64 moves = std::count(inRun.cbegin(), inRun.cend(), false);
+    const qint64 operations = removals + inserts + moves;
+    if (operations * qMax<qint64>(items.size(), 1) > kDiffWorkBudget || operations > items.size() / 2) {
+        return false;
+    }
 
-    return item;
-}
+    const int previousCount = m_items.size();
+    for (int row = m_items.size() - 1; row >= 0;) {
+        if (keptIds.contains(m_items.id(row))) {
+            --row;
+            continue;
+        }
+        int first = row;
+        while (first > 0 && !keptIds.contains(m_items.id(first - 1))) {
+            --first;
+        }
+        for (int removed = first; removed <= row; ++removed) {
+            unindexItem(m_items.id(removed));
+        }
+        beginRemoveRows(QModelIndex(), first, row);
+        m_items.remove(first, row - first + 1);
+        m_rowIndexValid = false;
+        endRemoveRows();
+        row = first - 1;
+    }
 
-QString LibraryModel::resolveUrl(const QString &value) const {
-    const QString trimmed = value.trimmed();
-    if (trimmed.isEmpty()) {
-        return QString();
+    // Only kept rows outside the increasing run move. Each moves once, to
+    // just after its predecessor in the new order; taking them in new order
+    // means the predecessor is already in place.
+    QVector<int> keptTargets = keptOrder;
+    std::sort(keptTargets.begin(), keptTargets.end());
+    QVector<int> movers;
+    movers.reserve(moves);
+    for (int i = 0; i < keptOrder.size(); ++i) {
+        if (!inRun.at(i)) {
+            movers.append(keptOrder.at(i));
+        }
+    }
+    std::sort(movers.begin(), movers.end());
+    const auto rowOf = [this](const QString &id) {
+        int row = 0;
+        while (m_items.id(row) != id) {
+            ++row;
+        }
+        return row;
+    };
+    for (const int target : std::as_const(movers)) {
+        const auto rank = std::lower_bound(keptTargets.cbegin(), keptTargets.cend(), target);
+        const int after = rank == keptTargets.cbegin() ? -1 : rowOf(items.at(*(rank - 1)).id);
+        const int from = rowOf(items.at(target).id);
+        if (from == after + 1) {
+            continue;
+        }
+        const int to = from < after ? after : after + 1;
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), after + 1);
+        m_items.move(from, to);
+        m_rowIndexValid = false;
+        endMoveRows();
     }
-    const QUrl url(trimmed);
-    if (!url.isRelative() || m_baseUrl.trimmed().isEmpty()) {
-        return trimmed;
+
+    // Kept rows are now in the new relative order, so every row that does
+    // not match is a new item.
+    QSet<QString> changedIds;
+    for (int row = 0; row < items.size(); ++row) {
+        const MediaItem &item = items.at(row);
+        if (row < m_items.size() && m_items.id(row) == item.id) {
+            const QVector<int> roles = changedRoles(m_items.differences(row, item));
+            if (!roles.isEmpty()) {
+                m_items.replace(row, item);
+                indexItem(item);
+                changedIds.insert(item.id);
+                emit dataChanged(index(row), index(row), roles);
+            }
+            continue;
+        }
+        beginInsertRows(QModelIndex(), row, row);
+        m_items.insert(row, item);
+        m_rowIndexValid = false;
+        endInsertRows();
+        indexItem(item);
     }
-    const QUrl base(m_baseUrl);
-    if (!base.isValid()) {
-        return trimmed;
+
+    if (operations > 0 || !changedIds.isEmpty()) {
+        m_sortOrderValid = false;
+        updateViews(false, changedIds);
     }
-    return base.resolved(QUrl(trimmed)).toString();
+    if (m_items.size() != previousCount) {
+        emit countChanged();
+    }
+    return true;
 }
 
-QString LibraryModel::extractImage(const QVariantMap &metadata, const QStringList &keys) const {
-    for (const QString &key : keys) {
-        const QVariant value = metadata.value(key);
-        if (!value.isValid()) {
-            continue;
+void LibraryModel::applyDelta(const QJsonArray &items, const QStringList &removedIds) {
+    const quint64 generation = m_libraryGeneration;
+    QtConcurrent::run(&m_buildPool, [items, baseUrl = m_baseUrl]() {
+        TraceSpan span("build items", "library");
+        return buildItems(items, baseUrl);
+    }).then(this, [this, generation, removedIds](const QVector<MediaItem> &built) {
+        if (generation != m_libraryGeneration) {
+            return;
         }
-        if (value.typeId() == QMetaType::QString) {
-            const QString url = value.toString();
-            if (!url.isEmpty()) {
-                return url;
-            }
-        } else if (value.typeId() == QMetaType::QVariantMap) {
-            const QVariantMap nested = value.toMap();
-            const QString url = nested.value("url").toString();
-            if (!url.isEmpty()) {
-                return url;
-            }
-            for (const QString &subKey : {"extraLarge", "large", "medium", "original", "path"}) {
-                const QString candidate = nested.value(subKey).toString();
-                if (!candidate.isEmpty()) {
-                    return candidate;
-                }
-            }
+        applyDeltaItems(built, removedIds);
+        if (!built.isEmpty() || !removedIds.isEmpty()) {
+            saveSnapshot();
         }
+    });
+}
+
+void LibraryModel::applyDeltaItems(const QVector<MediaItem> &items, const QStringList &removedIds) {
+    TraceSpan span("apply delta", "library");
+    const int previousCount = m_items.size();
+    QSet<QString> changedIds;
+
+    QSet<int> removedSet;
+    removedSet.reserve(removedIds.size());
+    for (const QString &id : removedIds) {
+        const int row = indexOfId(id);
+        if (row >= 0) {
+            removedSet.insert(row);
+        }
+    }
+    QVector<int> removedRows(removedSet.cbegin(), removedSet.cend());
+    std::sort(removedRows.begin(), removedRows.end(), std::greater<int>());
+    for (const int row : removedRows) {
+        unindexItem(m_items.id(row));
+        beginRemoveRows(QModelIndex(), row, row);
+        m_items.remove(row);
+        m_rowIndexValid = false;
+        endRemoveRows();
     }
 
-    if (metadata.contains("coverImage")) {
-        const QVariantMap cover = metadata.value("coverImage").toMap();
-        for (const QString &subKey : {"extraLarge", "large", "medium", "color"}) {
-            const QString candidate = cover.value(subKey).toString();
-            if (!candidate.isEmpty()) {
-                return candidate;
+    for (const MediaItem &item : items) {
+        const int row = indexOfId(item.id);
+        if (row >= 0) {
+            const QVector<int> roles = changedRoles(m_items.differences(row, item));
+            if (!roles.isEmpty()) {
+                m_items.replace(row, item);
+                indexItem(item);
+                changedIds.insert(item.id);
+                emit dataChanged(index(row), index(row), roles);
             }
+        } else {
+            const int insertRow = m_items.size();
+            beginInsertRows(QModelIndex(), insertRow, insertRow);
+            m_items.append(item);
+            if (m_rowIndexValid) {
+                m_rowById.insert(item.id, insertRow);
+            }
+            endInsertRows();
+            indexItem(item);
         }
+        advanceSyncCursor(item);
+    }
+
+    if (!items.isEmpty() || !removedIds.isEmpty()) {
+        m_sortOrderValid = false;
+        updateViews(false, changedIds);
     }
+    if (m_items.size() != previousCount) {
+        emit countChanged();
+    }
+}
 
-    return QString();
+void LibraryModel::beginLibraryStream() {
+    ++m_streamGeneration;
+    m_streaming = true;
+    m_streamLive = m_items.isEmpty();
+    m_streamItems.clear();
+    m_streamCursor.clear();
+    m_streamCursorMs = 0;
 }
 
-QString LibraryModel::extractDescription(const QVariantMap &metadata) const {
-    for (const QString &key : {"description", "overview", "plot", "summary"}) {
-        const QString raw = metadata.value(key).toString();
-        if (raw.isEmpty()) {
-            continue;
+void LibraryModel::appendLibraryItems(const QByteArrayList &items) {
+    if (!m_streaming) {
+        return;
+    }
+    const quint64 generation = m_streamGeneration;
+    QtConcurrent::run(&m_buildPool, [items, baseUrl = m_baseUrl]() {
+        TraceSpan span("build items", "library");
+        return buildItems(items, baseUrl);
+    }).then(this, [this, generation](QVector<MediaItem> built) {
+        if (generation == m_streamGeneration && m_streaming) {
+            applyStreamBatch(std::move(built));
+        }
+    });
+}
+
+void LibraryModel::applyStreamBatch(QVector<MediaItem> items) {
+    for (const MediaItem &item : items) {
+        if (isNewerThan(item, m_streamCursorMs, m_streamCursor)) {
+            m_streamCursor = item.updatedAt;
+            m_streamCursorMs = item.updatedAtMs;
         }
-        QString cleaned;
-        cleaned.reserve(raw.size());
-        bool inTag = false;
-        for (const QChar &ch : raw) {
-            if (ch == '<') {
-                inTag = true;
-                continue;
+    }
+    if (items.isEmpty()) {
+        return;
+    }
+
+    if (!m_streamLive) {
+        m_streamItems.append(std::move(items));
+        return;
+    }
+    TraceSpan span("insert batch", "library");
+    const int first = m_items.size();
+    beginInsertRows(QModelIndex(), first, first + items.size() - 1);
+    m_items.append(items);
+    if (m_rowIndexValid) {
+        for (int row = first; row < m_items.size(); ++row) {
+            if (!m_rowById.contains(m_items.id(row))) {
+                m_rowById.insert(m_items.id(row), row);
             }
-            if (ch == '>') {
-                inTag = false;
-                continue;
+        }
+    }
+    for (const MediaItem &item : std::as_const(items)) {
+        indexItem(item);
+    }
+    m_sortOrderValid = false;
+    endInsertRows();
+    // Each update re-sorts the whole library, so batches arriving in quick
+    // succession share one.
+    if (!m_streamViewTimer.isActive()) {
+        m_streamViewTimer.start();
+    }
+    emit countChanged();
+}
+
+void LibraryModel::finishLibraryStream() {
+    if (!m_streaming) {
+        return;
+    }
+    // Queue behind any batches still being built so none are dropped.
+    const quint64 generation = m_streamGeneration;
+    QtConcurrent::run(&m_buildPool, []() {}).then(this, [this, generation]() {
+        if (generation != m_streamGeneration || !m_streaming) {
+            return;
+        }
+        m_streaming = false;
+        if (!m_streamLive) {
+            replaceItems(std::move(m_streamItems));
+            m_streamItems.clear();
+        } else {
+            if (m_streamViewTimer.isActive()) {
+                updateViews(false);
             }
-            if (!inTag) {
-                cleaned.append(ch);
+            m_streamViewTimer.setInterval(kStreamViewMinIntervalMs);
+            m_syncCursorMs = m_streamCursorMs;
+            if (m_syncCursor != m_streamCursor) {
+                m_syncCursor = m_streamCursor;
+                emit syncCursorChanged();
             }
         }
-        return cleaned.simplified();
+        saveSnapshot();
+    });
+}
+
+void LibraryModel::abortLibraryStream() {
+    ++m_streamGeneration;
+    m_streaming = false;
+    m_streamLive = false;
+    m_streamItems.clear();
+    m_streamCursor.clear();
+    m_streamCursorMs = 0;
+}
+
+void LibraryModel::advanceSyncCursor(const MediaItem &item) {
+    if (!isNewerThan(item, m_syncCursorMs, m_syncCursor)) {
+        return;
     }
-    return QString();
+    m_syncCursor = item.updatedAt;
+    m_syncCursorMs = item.updatedAtMs;
+    emit syncCursorChanged();
 }
 
-QString LibraryModel::extractTitle(const QVariantMap &metadata) const {
-    for (const QString &key : {"title", "name", "original_title", "original_name"}) {
-        const QString value = metadata.value(key).toString();
-        if (!value.isEmpty()) {
-            return value;
-        }
+void LibraryModel::applySearchQuery() {
+    // Supersede any query still on the worker.
+    m_searchGeneration->fetch_add(1);
+    if (m_searchQuery.trimmed().isEmpty()) {
+        m_searchTimer.stop();
+        publishSearch({}, {}, false, false, {});
+        return;
     }
+    m_searchTimer.start();
+}
 
-    if (metadata.contains("title")) {
-        const QVariantMap nested = metadata.value("title").toMap();
-        for (const QString &key : {"english", "romaji", "native"}) {
-            const QString value = nested.value(key).toString();
-            if (!value.isEmpty()) {
-                return value;
-            }
-        }
+// Runs in two passes on the search thread, behind any queued index updates:
+// the ranked title matches are published first so the list fills
+// immediately, then the exact matches complete it. Results from superseded
+// queries are dropped, and a pass that starts after its query was superseded
+// does no work.
+void LibraryModel::runSearch() {
+    const QString query = m_searchQuery.trimmed();
+    if (query.isEmpty()) {
+        return;
     }
+    syncSearchIndex();
+    const std::shared_ptr<const SearchIndex> index = m_searchIndex;
+    const std::shared_ptr<std::atomic<quint64>> latest = m_searchGeneration;
+    const quint64 generation = latest->fetch_add(1) + 1;
 
-    return QString();
+    QtConcurrent::run(&m_searchPool, [index, query, latest, generation]() {
+        if (latest->load() != generation) {
+            return QVector<SearchIndex::Match>();
+        }
+        TraceSpan span("ranked search", "library");
+        return index->rankedSearch(query, kRankedSearchLimit);
+    }).then(this, [this, index, query, latest, generation](const QVector<SearchIndex::Match> &matches) {
+        if (latest->load() != generation) {
+            return;
+        }
+        // The exact hits still belong to the previous query, so they are
+        // cleared rather than shown next to the new ranked results.
+        publishSearch({}, matches, true, false, {});
+        QtConcurrent::run(&m_searchPool, [index, query, latest, generation]() {
+            if (latest->load() != generation) {
+                return QStringList();
+            }
+            TraceSpan span("prefix search", "library");
+            return index->search(query);
+        }).then(this, [this, matches, latest, generation](const QStringList &hitIds) {
+            if (latest->load() == generation) {
+                publishSearch(hitIds, matches, false, false, {});
+            }
+        });
+    });
 }
 
-int LibraryModel::extractYear(const QVariantMap &metadata) const {
-    const int metaYear = metadata.value("year").toInt();
-    if (metaYear > 0) {
-        return metaYear;
+void LibraryModel::applySortMode() {
+    TraceSpan span("sort views", "library");
+    m_sortOrderValid = false;
+    updateViews(true);
+}
+
+void LibraryModel::applyFilterMode() {
+    if (m_filterMode == "movies") {
+        m_searchType = "movie";
+        m_searchRequireProgress = false;
+    } else if (m_filterMode == "series") {
+        m_searchType = "series";
+        m_searchRequireProgress = false;
+    } else if (m_filterMode == "anime") {
+        m_searchType = "anime";
+        m_searchRequireProgress = false;
+    } else if (m_filterMode == "continue") {
+        m_searchType.clear();
+        m_searchRequireProgress = true;
+    } else {
+        m_searchType.clear();
+        m_searchRequireProgress = false;
     }
+    updateViews(false);
+}
 
-    const QString date = metadata.value("release_date").toString();
-    if (date.size() >= 4) {
-        const int year = date.left(4).toInt();
-        if (year > 0) {
-            return year;
+const QVector<int> &LibraryModel::sortOrder() {
+    if (m_sortOrderValid) {
+        return m_sortOrder;
+    }
+    m_sortOrder.resize(m_items.size());
+    std::iota(m_sortOrder.begin(), m_sortOrder.end(), 0);
+    if (m_sortMode == "title") {
+        if (m_titleSortKeys.size() > 2 * m_items.size() + 64) {
+            m_titleSortKeys.clear();
+        }
+        // Keys are made once per distinct title and reused across sorts.
+        for (int row = 0; row < m_items.size(); ++row) {
+            const QString &title = m_items.title(row);
+            if (!m_titleSortKeys.contains(title)) {
+                m_titleSortKeys.emplace(title, m_collator.sortKey(title));
+            }
+        }
+        QVector<const QCollatorSortKey *> keys;
+        keys.reserve(m_items.size());
+        for (int row = 0; row < m_items.size(); ++row) {
+            keys.append(&m_titleSortKeys.constFind(m_items.title(row)).value());
+        }
+        std::stable_sort(m_sortOrder.begin(), m_sortOrder.end(), [&keys](int left, int right) {
+            return keys.at(left)->compare(*keys.at(right)) < 0;
+        });
+    } else {
+        // Every other mode is newest or largest first on an integer column.
+        qint64 (*column)(const LibraryStore &, int) = [](const LibraryStore &items, int row) {
+            return items.updatedAtMs(row);
+        };
+        if (m_sortMode == "year") {
+            column = [](const LibraryStore &items, int row) { return qint64(items.year(row)); };
+        } else if (m_sortMode == "runtime") {
+            column = [](const LibraryStore &items, int row) { return qint64(items.runtimeSeconds(row)); };
+        } else if (m_sortMode == "progress") {
+            column = [](const LibraryStore &items, int row) { return qRound64(items.progress(row) * 1000000.0); };
+        } else if (m_sortMode == "added") {
+            column = [](const LibraryStore &items, int row) { return items.addedAtMs(row); };
+        }
+        QVector<quint64> keys;
+        keys.reserve(m_items.size());
+        for (int row = 0; row < m_items.size(); ++row) {
+            keys.append(~orderedKey(column(m_items, row)));
         }
+        radixSort(&m_sortOrder, keys);
     }
+    m_sortOrderValid = true;
+    return m_sortOrder;
+}
+
+void LibraryModel::updateViews(bool reset, const QSet<QString> &changedIds) {
+    TraceSpan span("update views", "library");
+    // This pass covers any rows a stream appended since the last one.
+    m_streamViewTimer.stop();
+    struct ViewRows {
+        MediaViewModel *model;
+        QVector<int> rows;
+        QStringList ids;
+    };
+    ViewRows all{&m_allModel, {}, {}};
+    ViewRows movies{&m_moviesModel, {}, {}};
+    ViewRows series{&m_seriesModel, {}, {}};
+    ViewRows anime{&m_animeModel, {}, {}};
+    ViewRows continueWatching{&m_continueModel, {}, {}};
+    all.rows.reserve(m_items.size());
+    all.ids.reserve(m_items.size());
 
-    const QString firstAir = metadata.value("first_air_date").toString();
-    if (firstAir.size() >= 4) {
-        const int year = firstAir.left(4).toInt();
-        if (year > 0) {
-            return year;
+    // One walk over the shared sort order fills every view, so each keeps
+    // the same relative order without sorting on its own.
+    for (const int row : sortOrder()) {
+        const QString &id = m_items.id(row);
+        const QString &type = m_items.type(row);
+        const auto add = [row, &id](ViewRows &view) {
+            view.rows.append(row);
+            view.ids.append(id);
+        };
+        add(all);
+        if (type == QLatin1String("movie")) {
+            add(movies);
+        } else if (type == QLatin1String("series")) {
+            add(series);
+        } else if (type == QLatin1String("anime")) {
+            add(anime);
+        }
+        if (m_items.progress(row) > 0.0) {
+            add(continueWatching);
         }
     }
 
-    const QVariantMap startDate = metadata.value("startDate").toMap();
-    const int startYear = startDate.value("year").toInt();
-    if (startYear > 0) {
-        return startYear;
+    for (ViewRows *view : {&all, &movies, &series, &anime, &continueWatching}) {
+        if (reset) {
+            view->model->resetRows(view->rows, view->ids);
+        } else {
+            view->model->setRows(view->rows, view->ids, changedIds);
+        }
     }
 
-    return 0;
+    // Rows under the current results may have moved, so those are mapped to
+    // the new rows now; the query itself is re-run on the search thread like
+    // a keystroke, after the index has caught up.
+    if (m_searchIndexValid) {
+        syncSearchIndex();
+    }
+    publishSearch(m_searchHitIds, m_searchMatches, m_searchPartial, reset, changedIds);
+    if (!m_searchQuery.trimmed().isEmpty()) {
+        m_searchGeneration->fetch_add(1);
+        m_searchTimer.start();
+    }
 }
 
-QStringList LibraryModel::extractGenres(const QVariantMap &map, const QVariantMap &metadata) const {
-    QStringList genres;
-    auto addGenre = [&genres](const QString &value) {
-        const QString trimmed = value.trimmed();
-        if (!trimmed.isEmpty() && !genres.contains(trimmed)) {
-            genres.append(trimmed);
-        }
+// Search rows are the exact index hits in sort order. Ranked rows lead with
+// the fuzzy title matches by relevance and follow with the remaining exact
+// hits; a partial publish only shows the ranked matches, and keeps the
+// previous exact hits until the new ones arrive.
+void LibraryModel::publishSearch(const QStringList &hitIds, const QVector<SearchIndex::Match> &matches,
+                                 bool partial, bool reset, const QSet<QString> &changedIds) {
+    TraceSpan span("publish search", "library");
+    m_searchHitIds = hitIds;
+    m_searchMatches = matches;
+    m_searchPartial = partial;
+    const auto searchable = [this](int row) {
+        return (m_searchType.isEmpty() || m_items.type(row) == m_searchType)
+            && (!m_searchRequireProgress || m_items.progress(row) > 0.0);
     };
+    const bool queryEmpty = m_searchQuery.trimmed().isEmpty();
 
-    const QVariant rawGenres = map.value("genres");
-    if (rawGenres.canConvert<QVariantList>()) {
-        const QVariantList list = rawGenres.toList();
-        for (const QVariant &entry : list) {
-            addGenre(entry.toString());
-        }
-    }
-    if (genres.isEmpty() && rawGenres.canConvert<QStringList>()) {
-        const QStringList list = rawGenres.toStringList();
-        for (const QString &entry : list) {
-            addGenre(entry);
+    QVector<int> rankedRows;
+    QStringList rankedIds;
+    QVector<bool> ranked(m_items.size(), false);
+    for (const SearchIndex::Match &match : matches) {
+        const int row = indexOfId(match.id);
+        if (row >= 0 && !ranked.at(row) && searchable(row)) {
+            rankedRows.append(row);
+            rankedIds.append(match.id);
+            ranked[row] = true;
         }
     }
 
-    const QVariant metaGenres = metadata.value("genres");
-    if (genres.isEmpty() && metaGenres.canConvert<QVariantList>()) {
-        const QVariantList list = metaGenres.toList();
-        for (const QVariant &entry : list) {
-            addGenre(entry.toString());
+    QVector<bool> hits(m_items.size(), queryEmpty);
+    for (const QString &id : hitIds) {
+        const int row = indexOfId(id);
+        if (row >= 0) {
+            hits[row] = true;
         }
     }
-    if (genres.isEmpty() && metaGenres.canConvert<QStringList>()) {
-        const QStringList list = metaGenres.toStringList();
-        for (const QString &entry : list) {
-            addGenre(entry);
+    QVector<int> searchRows;
+    QStringList searchIds;
+    for (const int row : sortOrder()) {
+        if (!hits.at(row) || !searchable(row)) {
+            continue;
+        }
+        searchRows.append(row);
+        searchIds.append(m_items.id(row));
+        if (!partial && !queryEmpty && !ranked.at(row)) {
+            rankedRows.append(row);
+            rankedIds.append(m_items.id(row));
         }
     }
-    if (genres.isEmpty()) {
-        addGenre(metadata.value("genre").toString());
+    if (reset) {
+        m_searchModel.resetRows(searchRows, searchIds);
+    } else {
+        m_searchModel.setRows(searchRows, searchIds, changedIds);
     }
 
-    return genres;
-}
-
-void LibraryModel::applySearchQuery() {
-    m_searchModel.setSearchQuery(m_searchQuery);
+    if (reset) {
+        m_rankedSearchModel.resetRows(rankedRows, rankedIds);
+    } else {
+        m_rankedSearchModel.setRows(rankedRows, rankedIds, changedIds);
+    }
 }
 
-void LibraryModel::applySortMode() {
-    int role = MediaRoles::UpdatedAtRole;
-    Qt::SortOrder order = Qt::DescendingOrder;
-
-    if (m_sortMode == "title") {
-        role = MediaRoles::TitleRole;
-        order = Qt::AscendingOrder;
-    } else if (m_sortMode == "year") {
-        role = MediaRoles::YearRole;
-        order = Qt::DescendingOrder;
+// Builds the index on the search thread, or hands it the changes queued
+// since the last call. The search thread runs one task at a time in order,
+// so queries queued after this see every change made before it.
+void LibraryModel::syncSearchIndex() {
+    if (!m_searchIndexValid) {
+        m_searchIndex = std::make_shared<SearchIndex>();
+        m_searchIndexValid = true;
+        m_pendingIndexed.clear();
+        m_pendingUnindexed.clear();
+        // The copy shares the store's arrays; the store only copies them if
+        // it changes before the build is done.
+        QtConcurrent::run(&m_searchPool, [index = m_searchIndex, items = m_items]() {
+            TraceSpan span("build search index", "library");
+            for (int row = 0; row < items.size(); ++row) {
+                index->insert(items.at(row));
+            }
+        });
+        return;
     }
+    if (m_pendingIndexed.isEmpty() && m_pendingUnindexed.isEmpty()) {
+        return;
+    }
+    QtConcurrent::run(&m_searchPool, [index = m_searchIndex, removed = std::exchange(m_pendingUnindexed, {}),
+                                      added = std::exchange(m_pendingIndexed, {})]() {
+        TraceSpan span("update search index", "library");
+        for (const QString &id : removed) {
+            index->remove(id);
+        }
+        for (const MediaItem &item : added) {
+            index->insert(item);
+        }
+    });
+}
 
-    for (MediaFilterModel *model : {&m_allModel, &m_moviesModel, &m_seriesModel, &m_animeModel, &m_continueModel, &m_searchModel}) {
-        model->setSortRole(role);
-        model->sort(0, order);
+void LibraryModel::indexItem(const MediaItem &item) {
+    if (m_searchIndexValid) {
+        m_pendingIndexed.insert(item.id, item);
     }
 }
 
-void LibraryModel::applyFilterMode() {
-    if (m_filterMode == "movies") {
-        m_searchModel.setTypeFilter("movie");
-        m_searchModel.setRequireProgress(false);
-    } else if (m_filterMode == "series") {
-        m_searchModel.setTypeFilter("series");
-        m_searchModel.setRequireProgress(false);
-    } else if (m_filterMode == "anime") {
-        m_searchModel.setTypeFilter("anime");
-        m_searchModel.setRequireProgress(false);
-    } else if (m_filterMode == "continue") {
-        m_searchModel.setTypeFilter(QString());
-        m_searchModel.setRequireProgress(true);
-    } else {
-        m_searchModel.setTypeFilter(QString());
-        m_searchModel.setRequireProgress(false);
+void LibraryModel::unindexItem(const QString &id) {
+    if (m_searchIndexValid) {
+        m_pendingIndexed.remove(id);
+        m_pendingUnindexed.insert(id);
     }
 }
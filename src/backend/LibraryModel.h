@@ -1,11 +1,21 @@
 #pragma once
 
 #include <QAbstractListModel>
-#include <QSortFilterProxyModel>
+#include <QByteArrayList>
+#include <QCollator>
+#include <QHash>
+#include <QJsonArray>
+#include <QSet>
 #include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
 #include <QVector>
+#include <atomic>
+#include <memory>
 
+#include "backend/LibraryStore.h"
 #include "backend/MediaItem.h"
+#include "backend/SearchIndex.h"
 
 namespace MediaRoles {
     enum Role {
@@ -23,50 +33,70 @@ namespace MediaRoles {
     };
 }
 
-class MediaFilterModel : public QSortFilterProxyModel {
-    Q_OBJECT
-    Q_PROPERTY(QString typeFilter READ typeFilter WRITE setTypeFilter NOTIFY typeFilterChanged)
-    Q_PROPERTY(QString searchQuery READ searchQuery WRITE setSearchQuery NOTIFY searchQueryChanged)
-    Q_PROPERTY(bool requireProgress READ requireProgress WRITE setRequireProgress NOTIFY requireProgressChanged)
-    Q_PROPERTY(int count READ count NOTIFY countChanged)
+class LibraryModel;
+
+// Typed view of one library item for QML, so single-item lookups read fields
+// directly instead of going through a QVariantMap.
+struct LibraryItem : MediaItem {
+    Q_GADGET
+    Q_PROPERTY(bool valid READ isValid)
+    Q_PROPERTY(QString mediaId MEMBER id)
+    Q_PROPERTY(QString title MEMBER title)
+    Q_PROPERTY(QString type MEMBER type)
+    Q_PROPERTY(int year MEMBER year)
+    Q_PROPERTY(QString poster MEMBER posterUrl)
+    Q_PROPERTY(QString backdrop MEMBER backdropUrl)
+    Q_PROPERTY(QString overview MEMBER overview)
+    Q_PROPERTY(QStringList genres MEMBER genres)
+    Q_PROPERTY(double progress MEMBER progress)
+    Q_PROPERTY(int runtime MEMBER runtimeSeconds)
+    Q_PROPERTY(QString updatedAt MEMBER updatedAt)
 
 public:
-    explicit MediaFilterModel(QObject *parent = nullptr);
+    LibraryItem() = default;
+    explicit LibraryItem(const MediaItem &item) : MediaItem(item) {}
 
-    QString typeFilter() const;
-    void setTypeFilter(const QString &value);
+    bool isValid() const { return !id.isEmpty(); }
+};
 
-    QString searchQuery() const;
-    void setSearchQuery(const QString &value);
+// A filtered, sorted view of LibraryModel. LibraryModel computes the rows of
+// every view in one pass; this model only maps rows and diffs updates by id.
+class MediaViewModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
 
-    bool requireProgress() const;
-    void setRequireProgress(bool value);
+public:
+    explicit MediaViewModel(LibraryModel *source, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
 
     int count() const;
 
+    void setRows(const QVector<int> &rows, const QStringList &ids, const QSet<QString> &changedIds);
+    void resetRows(const QVector<int> &rows, const QStringList &ids);
+
 signals:
-    void typeFilterChanged();
-    void searchQueryChanged();
-    void requireProgressChanged();
     void countChanged();
 
-protected:
-    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
-
 private:
-    QString m_typeFilter;
-    QString m_searchQuery;
-    bool m_requireProgress = false;
+    LibraryModel *m_source = nullptr;
+    QVector<int> m_rows;
+    QStringList m_ids;
 };
 
 class LibraryModel : public QAbstractListModel {
     Q_OBJECT
     Q_PROPERTY(int count READ count NOTIFY countChanged)
     Q_PROPERTY(QString baseUrl READ baseUrl WRITE setBaseUrl NOTIFY baseUrlChanged)
+    Q_PROPERTY(QString accountId READ accountId WRITE setAccountId NOTIFY accountIdChanged)
     Q_PROPERTY(QString searchQuery READ searchQuery WRITE setSearchQuery NOTIFY searchQueryChanged)
     Q_PROPERTY(QString sortMode READ sortMode WRITE setSortMode NOTIFY sortModeChanged)
     Q_PROPERTY(QString filterMode READ filterMode WRITE setFilterMode NOTIFY filterModeChanged)
+    Q_PROPERTY(QString syncCursor READ syncCursor NOTIFY syncCursorChanged)
     Q_PROPERTY(QAbstractItemModel* searchModel READ searchModel CONSTANT)
+    Q_PROPERTY(QAbstractItemModel* rankedSearchModel READ rankedSearchModel CONSTANT)
 
 public:
     explicit LibraryModel(QObject *parent = nullptr);
@@ -79,12 +109,14 @@ public:
 
     Q_INVOKABLE QVariantMap get(int index) const;
     Q_INVOKABLE int indexOfId(const QString &id) const;
+    Q_INVOKABLE LibraryItem itemById(const QString &id) const;
     Q_INVOKABLE QAbstractItemModel *allModel();
     Q_INVOKABLE QAbstractItemModel *moviesModel();
     Q_INVOKABLE QAbstractItemModel *seriesModel();
     Q_INVOKABLE QAbstractItemModel *animeModel();
     Q_INVOKABLE QAbstractItemModel *continueWatchingModel();
     Q_INVOKABLE QAbstractItemModel *searchModel();
+    Q_INVOKABLE QAbstractItemModel *rankedSearchModel();
 
     QString searchQuery() const;
     void setSearchQuery(const QString &value);
@@ -92,43 +124,100 @@ public:
     QString baseUrl() const;
     void setBaseUrl(const QString &value);
 
+    QString accountId() const;
+    void setAccountId(const QString &value);
+
     QString sortMode() const;
     void setSortMode(const QString &value);
 
     QString filterMode() const;
     void setFilterMode(const QString &value);
 
+    QString syncCursor() const;
+
+    bool loadSnapshot();
+    // Drops every item and the sync cursor, so the next sync is a full one.
+    Q_INVOKABLE void resetLibrary();
+
 public slots:
     void setItems(const QVariantList &items);
+    void replaceLibrary(const QJsonArray &items);
+    void applyDelta(const QJsonArray &items, const QStringList &removedIds);
+    void beginLibraryStream();
+    void appendLibraryItems(const QByteArrayList &items);
+    void finishLibraryStream();
+    void abortLibraryStream();
 
 signals:
     void countChanged();
     void baseUrlChanged();
+    void accountIdChanged();
     void searchQueryChanged();
     void sortModeChanged();
     void filterModeChanged();
+    void syncCursorChanged();
 
 private:
-    MediaItem itemFromVariant(const QVariantMap &map) const;
-    QString extractImage(const QVariantMap &metadata, const QStringList &keys) const;
-    QString extractDescription(const QVariantMap &metadata) const;
-    QString extractTitle(const QVariantMap &metadata) const;
-    int extractYear(const QVariantMap &metadata) const;
-    QStringList extractGenres(const QVariantMap &map, const QVariantMap &metadata) const;
-    QString resolveUrl(const QString &value) const;
+    void replaceItems(QVector<MediaItem> items);
+    bool diffItems(const QVector<MediaItem> &items);
     void applySearchQuery();
     void applySortMode();
     void applyFilterMode();
-
-    QVector<MediaItem> m_items;
-    MediaFilterModel m_allModel;
-    MediaFilterModel m_moviesModel;
-    MediaFilterModel m_seriesModel;
-    MediaFilterModel m_animeModel;
-    MediaFilterModel m_continueModel;
-    MediaFilterModel m_searchModel;
+    void advanceSyncCursor(const MediaItem &item);
+    void applyStreamBatch(QVector<MediaItem> items);
+    void applyDeltaItems(const QVector<MediaItem> &items, const QStringList &removedIds);
+    void saveSnapshot();
+    const QVector<int> &sortOrder();
+    void updateViews(bool reset, const QSet<QString> &changedIds = QSet<QString>());
+    void syncSearchIndex();
+    void runSearch();
+    void publishSearch(const QStringList &hitIds, const QVector<SearchIndex::Match> &matches, bool partial,
+                       bool reset, const QSet<QString> &changedIds);
+    void indexItem(const MediaItem &item);
+    void unindexItem(const QString &id);
+
+    LibraryStore m_items;
+    mutable QHash<QString, int> m_rowById;
+    mutable bool m_rowIndexValid = false;
+    // Only the search thread touches the index; changes are queued to it.
+    std::shared_ptr<SearchIndex> m_searchIndex;
+    bool m_searchIndexValid = false;
+    QHash<QString, MediaItem> m_pendingIndexed;
+    QSet<QString> m_pendingUnindexed;
+    QThreadPool m_searchPool;
+    QTimer m_searchTimer;
+    std::shared_ptr<std::atomic<quint64>> m_searchGeneration = std::make_shared<std::atomic<quint64>>(0);
+    QTimer m_streamViewTimer;
+    QVector<int> m_sortOrder;
+    QCollator m_collator;
+    QHash<QString, QCollatorSortKey> m_titleSortKeys;
+    bool m_sortOrderValid = false;
+    MediaViewModel m_allModel;
+    MediaViewModel m_moviesModel;
+    MediaViewModel m_seriesModel;
+    MediaViewModel m_animeModel;
+    MediaViewModel m_continueModel;
+    MediaViewModel m_searchModel;
+    MediaViewModel m_rankedSearchModel;
+    QString m_searchType;
+    bool m_searchRequireProgress = false;
+    QStringList m_searchHitIds;
+    QVector<SearchIndex::Match> m_searchMatches;
+    bool m_searchPartial = false;
     QString m_baseUrl;
+    QString m_accountId;
+    // Bumped by resetLibrary so builds started before it are dropped.
+    quint64 m_libraryGeneration = 0;
     QString m_searchQuery;
     QString m_sortMode = "recent";
     QString m_filterMode = "all";
+    QString m_syncCursor;
+    qint64 m_syncCursorMs = 0;
+    QVector<MediaItem> m_streamItems;
+    QString m_streamCursor;
+    qint64 m_streamCursorMs = 0;
+    bool m_streaming = false;
+    bool m_streamLive = false;
+    quint64 m_streamGeneration = 0;
+    QThreadPool m_buildPool;
 };
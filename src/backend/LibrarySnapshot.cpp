@@ -0,0 +1,98 @@
+#include "backend/LibrarySnapshot.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+constexpr quint32 kSnapshotMagic = 0x454c584c;
+constexpr quint16 kSnapshotVersion = 4;
+// Smallest encoded item: seven empty strings, two empty lists, two ints, a
+// double and two timestamps.
+constexpr qint64 kMinItemBytes = 7 * 4 + 2 * 4 + 2 * 4 + 8 + 2 * 8;
+} // namespace
+
+QString LibrarySnapshot::pathFor(const QString &baseUrl, const QString &accountId) {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (dir.isEmpty() || baseUrl.isEmpty() || accountId.isEmpty()) {
+        return QString();
+    }
+    const QByteArray hash =
+        QCryptographicHash::hash((baseUrl + '\n' + accountId).toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QDir(dir).filePath(QString("library-%1.snapshot").arg(QString::fromLatin1(hash)));
+}
+
+bool LibrarySnapshot::write(const QString &path, const QString &baseUrl, const QString &accountId,
+                            const QVector<MediaItem> &items) {
+    if (path.isEmpty()) {
+        return false;
+    }
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << kSnapshotMagic << kSnapshotVersion << baseUrl << accountId << static_cast<quint32>(items.size());
+    for (const MediaItem &item : items) {
+        out << item.id << item.title << item.type << static_cast<qint32>(item.year) << item.updatedAt
+            << static_cast<qint32>(item.runtimeSeconds) << item.posterUrl << item.backdropUrl
+            << item.overview << item.genres << item.progress << item.alternateTitles
+            << item.updatedAtMs << item.addedAtMs;
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool LibrarySnapshot::read(const QString &path, const QString &baseUrl, const QString &accountId,
+                           QVector<MediaItem> *items) {
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly) || file.size() == 0) {
+        return false;
+    }
+    uchar *mapped = file.map(0, file.size());
+    if (!mapped) {
+        return false;
+    }
+    // Strings are copied out as they are decoded, so the mapping can go
+    // away once the stream is done.
+    const QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), file.size());
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    QString storedBaseUrl;
+    QString storedAccountId;
+    quint32 count = 0;
+    in >> magic >> version >> storedBaseUrl >> storedAccountId >> count;
+    bool ok = in.status() == QDataStream::Ok && magic == kSnapshotMagic && version == kSnapshotVersion
+        && storedBaseUrl == baseUrl && !accountId.isEmpty() && storedAccountId == accountId
+        && count <= file.size() / kMinItemBytes;
+
+    QVector<MediaItem> loaded;
+    if (ok) {
+        loaded.reserve(count);
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            MediaItem item;
+            qint32 year = 0;
+            qint32 runtimeSeconds = 0;
+            in >> item.id >> item.title >> item.type >> year >> item.updatedAt >> runtimeSeconds
+               >> item.posterUrl >> item.backdropUrl >> item.overview >> item.genres >> item.progress
+               >> item.alternateTitles >> item.updatedAtMs >> item.addedAtMs;
+            item.year = year;
+            item.runtimeSeconds = runtimeSeconds;
+            loaded.push_back(std::move(item));
+        }
+        ok = in.status() == QDataStream::Ok;
+    }
+    file.unmap(mapped);
+    if (ok) {
+        *items = std::move(loaded);
+    }
+    return ok;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include "backend/MediaItem.h"
+
+// Versioned binary copy of the library, written after each sync and mapped
+// at startup so the home screen can show items before any network activity.
+// Items carry the account's progress, so each server and account has its own
+// file, and a file is only read back for the account that wrote it.
+namespace LibrarySnapshot {
+    // Empty when either part is unknown.
+    QString pathFor(const QString &baseUrl, const QString &accountId);
+    bool write(const QString &path, const QString &baseUrl, const QString &accountId,
+               const QVector<MediaItem> &items);
+    bool read(const QString &path, const QString &baseUrl, const QString &accountId, QVector<MediaItem> *items);
+}
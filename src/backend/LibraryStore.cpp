@@ -0,0 +1,441 @@
+#include "backend/LibraryStore.h"
+
+#include <QStringView>
+
+namespace {
+// Arenas are rewritten once at least this much of them is dead text.
+constexpr qint64 kMinCompactGarbage = 64 * 1024;
+// Rough per-allocation header of Qt's shared array data.
+constexpr qint64 kArrayHeaderBytes = 16;
+
+qint64 stringBytes(const QString &value) {
+    return value.isNull() ? 0 : kArrayHeaderBytes + (value.capacity() + 1) * qint64(sizeof(QChar));
+}
+
+qint64 listBytes(const QStringList &values) {
+    if (values.isEmpty()) {
+        return 0;
+    }
+    qint64 bytes = kArrayHeaderBytes + values.capacity() * qint64(sizeof(QString));
+    for (const QString &value : values) {
+        bytes += stringBytes(value);
+    }
+    return bytes;
+}
+} // namespace
+
+template <typename Store, typename Function>
+void LibraryStore::forEachColumn(Store &store, Function function) {
+    function(store.m_ids);
+    function(store.m_titles);
+    function(store.m_alternateTitles);
+    function(store.m_types);
+    function(store.m_years);
+    function(store.m_runtimes);
+    function(store.m_progress);
+    function(store.m_updatedAtMs);
+    function(store.m_addedAtMs);
+    function(store.m_updatedAt);
+    function(store.m_posters);
+    function(store.m_backdrops);
+    function(store.m_overviews);
+    function(store.m_genres);
+}
+
+int LibraryStore::size() const {
+    return m_ids.size();
+}
+
+bool LibraryStore::isEmpty() const {
+    return m_ids.isEmpty();
+}
+
+MediaItem LibraryStore::at(int row) const {
+    MediaItem item;
+    item.id = m_ids.at(row);
+    item.title = m_titles.at(row);
+    item.alternateTitles = alternateTitles(row);
+    item.type = type(row);
+    item.year = m_years.at(row);
+    item.updatedAt = updatedAt(row);
+    item.updatedAtMs = m_updatedAtMs.at(row);
+    item.addedAtMs = m_addedAtMs.at(row);
+    item.runtimeSeconds = m_runtimes.at(row);
+    item.posterUrl = posterUrl(row);
+    item.backdropUrl = backdropUrl(row);
+    item.overview = overview(row);
+    item.genres = genres(row);
+    item.progress = m_progress.at(row);
+    return item;
+}
+
+QVector<MediaItem> LibraryStore::toItems() const {
+    QVector<MediaItem> items;
+    items.reserve(size());
+    for (int row = 0; row < size(); ++row) {
+        items.append(at(row));
+    }
+    return items;
+}
+
+void LibraryStore::assign(const QVector<MediaItem> &items) {
+    clear();
+    forEachColumn(*this, [&items](auto &column) {
+        column.reserve(items.size());
+    });
+    append(items);
+}
+
+void LibraryStore::append(const MediaItem &item) {
+    insert(size(), item);
+}
+
+void LibraryStore::append(const QVector<MediaItem> &items) {
+    for (const MediaItem &item : items) {
+        insert(size(), item);
+    }
+}
+
+void LibraryStore::insert(int row, const MediaItem &item) {
+    m_ids.insert(row, item.id);
+    m_titles.insert(row, item.title);
+    m_alternateTitles.insert(row, storeAlternateTitles(item.alternateTitles));
+    m_types.insert(row, internType(item.type));
+    m_years.insert(row, item.year);
+    m_runtimes.insert(row, item.runtimeSeconds);
+    m_progress.insert(row, item.progress);
+    m_updatedAtMs.insert(row, item.updatedAtMs);
+    m_addedAtMs.insert(row, item.addedAtMs);
+    m_updatedAt.insert(row, storeText(item.updatedAt));
+    m_posters.insert(row, storeUrl(item.posterUrl));
+    m_backdrops.insert(row, storeUrl(item.backdropUrl));
+    m_overviews.insert(row, storeText(item.overview));
+    m_genres.insert(row, storeGenres(item.genres));
+}
+
+void LibraryStore::replace(int row, const MediaItem &item) {
+    releaseRow(row);
+    m_ids[row] = item.id;
+    m_titles[row] = item.title;
+    m_alternateTitles[row] = storeAlternateTitles(item.alternateTitles);
+    m_types[row] = internType(item.type);
+    m_years[row] = item.year;
+    m_runtimes[row] = item.runtimeSeconds;
+    m_progress[row] = item.progress;
+    m_updatedAtMs[row] = item.updatedAtMs;
+    m_addedAtMs[row] = item.addedAtMs;
+    m_updatedAt[row] = storeText(item.updatedAt);
+    m_posters[row] = storeUrl(item.posterUrl);
+    m_backdrops[row] = storeUrl(item.backdropUrl);
+    m_overviews[row] = storeText(item.overview);
+    m_genres[row] = storeGenres(item.genres);
+    compact();
+}
+
+void LibraryStore::remove(int row, int count) {
+    for (int i = row; i < row + count; ++i) {
+        releaseRow(i);
+    }
+    forEachColumn(*this, [row, count](auto &column) {
+        column.remove(row, count);
+    });
+    compact();
+}
+
+void LibraryStore::move(int from, int to) {
+    forEachColumn(*this, [from, to](auto &column) {
+        column.move(from, to);
+    });
+}
+
+void LibraryStore::clear() {
+    forEachColumn(*this, [](auto &column) {
+        column.clear();
+    });
+    m_text.clear();
+    m_textGarbage = 0;
+    m_alternateArena.clear();
+    m_alternateGarbage = 0;
+    m_typeNames.clear();
+    m_typeLookup.clear();
+    m_genreNames.clear();
+    m_genreLists = {QStringList()};
+    m_genreListLookup = {{QStringList(), 0}};
+    m_urlPrefixes = {QString()};
+    m_urlPrefixLookup = {{QString(), 0}};
+}
+
+LibraryStore::Fields LibraryStore::differences(int row, const MediaItem &item) const {
+    Fields fields;
+    bool titles = m_titles.at(row) == item.title
+        && m_alternateTitles.at(row).length == quint32(item.alternateTitles.size());
+    for (qsizetype i = 0; titles && i < item.alternateTitles.size(); ++i) {
+        titles = textView(m_alternateArena.at(m_alternateTitles.at(row).offset + i)) == item.alternateTitles.at(i);
+    }
+    if (!titles) {
+        fields |= TitleField;
+    }
+    if (type(row) != item.type) {
+        fields |= TypeField;
+    }
+    if (m_years.at(row) != item.year) {
+        fields |= YearField;
+    }
+    if (!urlEquals(m_posters.at(row), item.posterUrl)) {
+        fields |= PosterField;
+    }
+    if (!urlEquals(m_backdrops.at(row), item.backdropUrl)) {
+        fields |= BackdropField;
+    }
+    if (textView(m_overviews.at(row)) != item.overview) {
+        fields |= OverviewField;
+    }
+    if (genres(row) != item.genres) {
+        fields |= GenresField;
+    }
+    if (m_progress.at(row) != item.progress) {
+        fields |= ProgressField;
+    }
+    if (m_runtimes.at(row) != item.runtimeSeconds) {
+        fields |= RuntimeField;
+    }
+    if (textView(m_updatedAt.at(row)) != item.updatedAt || m_addedAtMs.at(row) != item.addedAtMs) {
+        fields |= UpdatedField;
+    }
+    return fields;
+}
+
+const QString &LibraryStore::id(int row) const {
+    return m_ids.at(row);
+}
+
+const QString &LibraryStore::title(int row) const {
+    return m_titles.at(row);
+}
+
+const QString &LibraryStore::type(int row) const {
+    return m_typeNames.at(m_types.at(row));
+}
+
+int LibraryStore::year(int row) const {
+    return m_years.at(row);
+}
+
+int LibraryStore::runtimeSeconds(int row) const {
+    return m_runtimes.at(row);
+}
+
+double LibraryStore::progress(int row) const {
+    return m_progress.at(row);
+}
+
+qint64 LibraryStore::updatedAtMs(int row) const {
+    return m_updatedAtMs.at(row);
+}
+
+qint64 LibraryStore::addedAtMs(int row) const {
+    return m_addedAtMs.at(row);
+}
+
+QString LibraryStore::updatedAt(int row) const {
+    return text(m_updatedAt.at(row));
+}
+
+QString LibraryStore::posterUrl(int row) const {
+    return url(m_posters.at(row));
+}
+
+QString LibraryStore::backdropUrl(int row) const {
+    return url(m_backdrops.at(row));
+}
+
+QString LibraryStore::overview(int row) const {
+    return text(m_overviews.at(row));
+}
+
+const QStringList &LibraryStore::genres(int row) const {
+    return m_genreLists.at(m_genres.at(row));
+}
+
+QStringList LibraryStore::alternateTitles(int row) const {
+    const TextRef &ref = m_alternateTitles.at(row);
+    QStringList titles;
+    titles.reserve(ref.length);
+    for (quint32 i = 0; i < ref.length; ++i) {
+        titles.append(text(m_alternateArena.at(ref.offset + i)));
+    }
+    return titles;
+}
+
+qint64 LibraryStore::bytesUsed() const {
+    qint64 bytes = 0;
+    forEachColumn(*this, [&bytes](const auto &column) {
+        bytes += column.capacity() * qint64(sizeof(column.at(0)));
+    });
+    for (int row = 0; row < size(); ++row) {
+        bytes += stringBytes(m_ids.at(row)) + stringBytes(m_titles.at(row));
+    }
+    bytes += stringBytes(m_text) + m_alternateArena.capacity() * qint64(sizeof(TextRef));
+    bytes += listBytes(m_typeNames) + listBytes(m_urlPrefixes);
+    // Lists share the interned name strings, so only their arrays count.
+    for (const QString &name : m_genreNames) {
+        bytes += stringBytes(name);
+    }
+    for (const QStringList &names : m_genreLists) {
+        bytes += names.isEmpty() ? 0 : kArrayHeaderBytes + names.capacity() * qint64(sizeof(QString));
+    }
+    return bytes;
+}
+
+qint64 LibraryStore::bytesUsed(const QVector<MediaItem> &items) {
+    qint64 bytes = items.capacity() * qint64(sizeof(MediaItem));
+    for (const MediaItem &item : items) {
+        bytes += stringBytes(item.id) + stringBytes(item.title) + stringBytes(item.type)
+            + stringBytes(item.updatedAt) + stringBytes(item.posterUrl) + stringBytes(item.backdropUrl)
+            + stringBytes(item.overview) + listBytes(item.genres) + listBytes(item.alternateTitles);
+    }
+    return bytes;
+}
+
+LibraryStore::TextRef LibraryStore::storeText(const QString &value) {
+    if (value.isEmpty()) {
+        return TextRef();
+    }
+    TextRef ref;
+    ref.offset = quint32(m_text.size());
+    ref.length = quint32(value.size());
+    m_text.append(value);
+    return ref;
+}
+
+QStringView LibraryStore::textView(const TextRef &ref) const {
+    return QStringView(m_text).mid(ref.offset, ref.length);
+}
+
+QString LibraryStore::text(const TextRef &ref) const {
+    return ref.length == 0 ? QString() : m_text.mid(ref.offset, ref.length);
+}
+
+LibraryStore::UrlRef LibraryStore::storeUrl(const QString &value) {
+    const qsizetype split = value.lastIndexOf(QLatin1Char('/')) + 1;
+    const QString prefix = value.left(split);
+    UrlRef ref;
+    const auto it = m_urlPrefixLookup.constFind(prefix);
+    if (it != m_urlPrefixLookup.constEnd()) {
+        ref.prefix = it.value();
+    } else {
+        ref.prefix = quint32(m_urlPrefixes.size());
+        m_urlPrefixes.append(prefix);
+        m_urlPrefixLookup.insert(prefix, ref.prefix);
+    }
+    ref.suffix = storeText(value.mid(split));
+    return ref;
+}
+
+QString LibraryStore::url(const UrlRef &ref) const {
+    const QString &prefix = m_urlPrefixes.at(ref.prefix);
+    if (prefix.isEmpty()) {
+        return text(ref.suffix);
+    }
+    QString value;
+    value.reserve(prefix.size() + ref.suffix.length);
+    value.append(prefix);
+    value.append(textView(ref.suffix));
+    return value;
+}
+
+bool LibraryStore::urlEquals(const UrlRef &ref, const QString &value) const {
+    const QString &prefix = m_urlPrefixes.at(ref.prefix);
+    return value.size() == prefix.size() + qsizetype(ref.suffix.length) && value.startsWith(prefix)
+        && QStringView(value).mid(prefix.size()) == textView(ref.suffix);
+}
+
+// Libraries repeat a small number of genre combinations, so each distinct
+// list is kept once and rows hand it out without copying.
+quint32 LibraryStore::storeGenres(const QStringList &genres) {
+    const auto it = m_genreListLookup.constFind(genres);
+    if (it != m_genreListLookup.constEnd()) {
+        return it.value();
+    }
+    QStringList names;
+    names.reserve(genres.size());
+    for (const QString &genre : genres) {
+        auto name = m_genreNames.constFind(genre);
+        if (name == m_genreNames.constEnd()) {
+            name = m_genreNames.insert(genre);
+        }
+        names.append(*name);
+    }
+    const quint32 id = quint32(m_genreLists.size());
+    m_genreLists.append(names);
+    m_genreListLookup.insert(names, id);
+    return id;
+}
+
+LibraryStore::TextRef LibraryStore::storeAlternateTitles(const QStringList &titles) {
+    TextRef ref;
+    ref.offset = quint32(m_alternateArena.size());
+    ref.length = quint32(titles.size());
+    for (const QString &title : titles) {
+        m_alternateArena.append(storeText(title));
+    }
+    return ref;
+}
+
+quint16 LibraryStore::internType(const QString &type) {
+    const auto it = m_typeLookup.constFind(type);
+    if (it != m_typeLookup.constEnd()) {
+        return it.value();
+    }
+    const quint16 id = quint16(m_typeNames.size());
+    m_typeNames.append(type);
+    m_typeLookup.insert(type, id);
+    return id;
+}
+
+void LibraryStore::releaseRow(int row) {
+    m_textGarbage += m_updatedAt.at(row).length + m_posters.at(row).suffix.length
+        + m_backdrops.at(row).suffix.length + m_overviews.at(row).length;
+    const TextRef &titles = m_alternateTitles.at(row);
+    for (quint32 i = 0; i < titles.length; ++i) {
+        m_textGarbage += m_alternateArena.at(titles.offset + i).length;
+    }
+    m_alternateGarbage += titles.length;
+}
+
+void LibraryStore::compact() {
+    if (m_textGarbage >= kMinCompactGarbage && m_textGarbage * 2 > m_text.size()) {
+        QString packed;
+        packed.reserve(m_text.size() - m_textGarbage);
+        const auto relocate = [this, &packed](TextRef &ref) {
+            const quint32 offset = quint32(packed.size());
+            packed.append(QStringView(m_text).mid(ref.offset, ref.length));
+            ref.offset = offset;
+        };
+        for (int row = 0; row < size(); ++row) {
+            relocate(m_updatedAt[row]);
+            relocate(m_posters[row].suffix);
+            relocate(m_backdrops[row].suffix);
+            relocate(m_overviews[row]);
+            const TextRef &titles = m_alternateTitles.at(row);
+            for (quint32 i = 0; i < titles.length; ++i) {
+                relocate(m_alternateArena[titles.offset + i]);
+            }
+        }
+        m_text = packed;
+        m_textGarbage = 0;
+    }
+    if (m_alternateGarbage >= kMinCompactGarbage && m_alternateGarbage * 2 > m_alternateArena.size()) {
+        QVector<TextRef> packed;
+        packed.reserve(m_alternateArena.size() - m_alternateGarbage);
+        for (TextRef &ref : m_alternateTitles) {
+            const quint32 offset = quint32(packed.size());
+            for (quint32 i = 0; i < ref.length; ++i) {
+                packed.append(m_alternateArena.at(ref.offset + i));
+            }
+            ref.offset = offset;
+        }
+        m_alternateArena = packed;
+        m_alternateGarbage = 0;
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QFlags>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "backend/MediaItem.h"
+
+// Column-oriented storage for the library. Sort and filter fields live in
+// contiguous arrays, types and genre lists are interned, image URLs share
+// their directory prefixes, and overviews, alternate titles and other cold
+// text sit in one arena.
+// Rows are materialized as MediaItem only when a caller needs all of them.
+class LibraryStore {
+public:
+    enum Field {
+        TitleField = 1 << 0,
+        TypeField = 1 << 1,
+        YearField = 1 << 2,
+        PosterField = 1 << 3,
+        BackdropField = 1 << 4,
+        OverviewField = 1 << 5,
+        GenresField = 1 << 6,
+        ProgressField = 1 << 7,
+        RuntimeField = 1 << 8,
+        UpdatedField = 1 << 9
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    int size() const;
+    bool isEmpty() const;
+
+    MediaItem at(int row) const;
+    QVector<MediaItem> toItems() const;
+
+    void assign(const QVector<MediaItem> &items);
+    void append(const MediaItem &item);
+    void append(const QVector<MediaItem> &items);
+    void insert(int row, const MediaItem &item);
+    void replace(int row, const MediaItem &item);
+    void remove(int row, int count = 1);
+    void move(int from, int to);
+    void clear();
+
+    // Fields of the row that differ from item, compared without copying the
+    // row out of the arenas.
+    Fields differences(int row, const MediaItem &item) const;
+
+    const QString &id(int row) const;
+    const QString &title(int row) const;
+    const QString &type(int row) const;
+    int year(int row) const;
+    int runtimeSeconds(int row) const;
+    double progress(int row) const;
+    qint64 updatedAtMs(int row) const;
+    qint64 addedAtMs(int row) const;
+    QString updatedAt(int row) const;
+    QString posterUrl(int row) const;
+    QString backdropUrl(int row) const;
+    QString overview(int row) const;
+    const QStringList &genres(int row) const;
+    QStringList alternateTitles(int row) const;
+
+    // Approximate heap and inline bytes held, for comparing layouts.
+    qint64 bytesUsed() const;
+    static qint64 bytesUsed(const QVector<MediaItem> &items);
+
+private:
+    struct TextRef {
+        quint32 offset = 0;
+        quint32 length = 0;
+    };
+    struct UrlRef {
+        quint32 prefix = 0;
+        TextRef suffix;
+    };
+
+    template <typename Store, typename Function>
+    static void forEachColumn(Store &store, Function function);
+
+    TextRef storeText(const QString &text);
+    QStringView textView(const TextRef &ref) const;
+    QString text(const TextRef &ref) const;
+    UrlRef storeUrl(const QString &url);
+    QString url(const UrlRef &ref) const;
+    bool urlEquals(const UrlRef &ref, const QString &value) const;
+    quint32 storeGenres(const QStringList &genres);
+    TextRef storeAlternateTitles(const QStringList &titles);
+    quint16 internType(const QString &type);
+    void releaseRow(int row);
+    void compact();
+
+    QVector<QString> m_ids;
+    QVector<QString> m_titles;
+    QVector<TextRef> m_alternateTitles;
+    QVector<quint16> m_types;
+    QVector<qint32> m_years;
+    QVector<qint32> m_runtimes;
+    QVector<double> m_progress;
+    QVector<qint64> m_updatedAtMs;
+    QVector<qint64> m_addedAtMs;
+    QVector<TextRef> m_updatedAt;
+    QVector<UrlRef> m_posters;
+    QVector<UrlRef> m_backdrops;
+    QVector<TextRef> m_overviews;
+    QVector<quint32> m_genres;
+
+    QString m_text;
+    qint64 m_textGarbage = 0;
+    QVector<TextRef> m_alternateArena;
+    qint64 m_alternateGarbage = 0;
+
+    QStringList m_typeNames;
+    QHash<QString, quint16> m_typeLookup;
+    QSet<QString> m_genreNames;
+    QVector<QStringList> m_genreLists = {QStringList()};
+    QHash<QStringList, quint32> m_genreListLookup = {{QStringList(), 0}};
+    QStringList m_urlPrefixes = {QString()};
+    QHash<QString, quint32> m_urlPrefixLookup = {{QString(), 0}};
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(LibraryStore::Fields)
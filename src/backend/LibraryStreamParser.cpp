@@ -0,0 +1,105 @@
+#include "backend/LibraryStreamParser.h"
+
+namespace {
+bool isJsonSpace(char ch) {
+    return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t';
+}
+
+bool isByteOrderMark(char ch) {
+    const auto byte = static_cast<unsigned char>(ch);
+    return byte == 0xEF || byte == 0xBB || byte == 0xBF;
+}
+} // namespace
+
+QByteArrayList LibraryStreamParser::feed(const QByteArray &chunk) {
+    QByteArrayList elements;
+    if (m_error) {
+        return elements;
+    }
+    m_buffer.append(chunk);
+
+    const char *data = m_buffer.constData();
+    const qsizetype size = m_buffer.size();
+    for (qsizetype i = m_scanPos; i < size; ++i) {
+        const char ch = data[i];
+
+        if (m_finished) {
+            if (!isJsonSpace(ch)) {
+                m_error = true;
+                break;
+            }
+            continue;
+        }
+
+        if (!m_started) {
+            if (ch == '[') {
+                m_started = true;
+            } else if (!isJsonSpace(ch) && !isByteOrderMark(ch)) {
+                m_error = true;
+                break;
+            }
+            continue;
+        }
+
+        if (m_inString) {
+            if (m_escape) {
+                m_escape = false;
+            } else if (ch == '\\') {
+                m_escape = true;
+            } else if (ch == '"') {
+                m_inString = false;
+            }
+            continue;
+        }
+
+        if (m_elementStart < 0) {
+            if (isJsonSpace(ch) || ch == ',') {
+                continue;
+            }
+            if (ch == ']') {
+                m_finished = true;
+                continue;
+            }
+            m_elementStart = i;
+            m_depth = 0;
+        }
+
+        if (ch == '"') {
+            m_inString = true;
+        } else if (ch == '{' || ch == '[') {
+            ++m_depth;
+        } else if (ch == '}' || ch == ']') {
+            if (m_depth == 0) {
+                elements.append(m_buffer.mid(m_elementStart, i - m_elementStart).trimmed());
+                m_elementStart = -1;
+                m_finished = true;
+            } else if (--m_depth == 0) {
+                elements.append(m_buffer.mid(m_elementStart, i + 1 - m_elementStart));
+                m_elementStart = -1;
+            }
+        } else if (ch == ',' && m_depth == 0) {
+            elements.append(m_buffer.mid(m_elementStart, i - m_elementStart).trimmed());
+            m_elementStart = -1;
+        }
+    }
+
+    const qsizetype keepFrom = m_elementStart >= 0 ? m_elementStart : size;
+    m_buffer.remove(0, keepFrom);
+    m_scanPos = m_buffer.size();
+    if (m_elementStart >= 0) {
+        m_elementStart = 0;
+    }
+    return elements;
+}
+
+bool LibraryStreamParser::started() const {
+    return m_started;
+}
+
+bool LibraryStreamParser::finished() const {
+    return m_finished && !m_error;
+}
+
+bool LibraryStreamParser::hasError() const {
+    return m_error;
+}
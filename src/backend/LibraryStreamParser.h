@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayList>
+
+// Splits a top-level JSON array into its element texts as bytes arrive, so
+// each element can be decoded on its own while the rest is still downloading.
+class LibraryStreamParser {
+public:
+    QByteArrayList feed(const QByteArray &chunk);
+
+    bool started() const;
+    bool finished() const;
+    bool hasError() const;
+
+private:
+    QByteArray m_buffer;
+    qsizetype m_scanPos = 0;
+    qsizetype m_elementStart = -1;
+    int m_depth = 0;
+    bool m_started = false;
+    bool m_finished = false;
+    bool m_error = false;
+    bool m_inString = false;
+    bool m_escape = false;
+};
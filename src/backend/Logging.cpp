@@ -0,0 +1,5 @@
+#include "backend/Logging.h"
+
+Q_LOGGING_CATEGORY(lcApi, "elixir.api")
+Q_LOGGING_CATEGORY(lcPlayer, "elixir.player")
+Q_LOGGING_CATEGORY(lcApp, "elixir.app")
@@ -6,9 +6,12 @@
 struct MediaItem {
     QString id;
     QString title;
+    QStringList alternateTitles;
     QString type;
     int year = 0;
     QString updatedAt;
+    qint64 updatedAtMs = 0;
+    qint64 addedAtMs = 0;
     int runtimeSeconds = 0;
     QString posterUrl;
     QString backdropUrl;
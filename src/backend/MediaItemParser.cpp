@@ -0,0 +1,457 @@
+#include "backend/MediaItemParser.h"
+
+#include "backend/JsonBackend.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QStringList>
+#include <QUrl>
+#include <initializer_list>
+#include <limits>
+
+namespace {
+// The extraction rules below are written once against this small set of
+// accessors and instantiated for QJsonValue and, when available, for
+// simdjson's DOM, so library payloads never round-trip through QJson.
+QJsonValue field(const QJsonValue &value, const char *key) {
+    return value.toObject().value(QLatin1String(key));
+}
+
+bool isString(const QJsonValue &value) {
+    return value.isString();
+}
+
+bool isObject(const QJsonValue &value) {
+    return value.isObject();
+}
+
+template <typename Function>
+void forEachElement(const QJsonValue &value, Function function) {
+    for (const QJsonValue &entry : value.toArray()) {
+        function(entry);
+    }
+}
+
+QString stringValue(const QJsonValue &value) {
+    if (value.isString()) {
+        return value.toString();
+    }
+    if (value.isDouble()) {
+        const double number = value.toDouble();
+        const qint64 integral = static_cast<qint64>(number);
+        return static_cast<double>(integral) == number
+            ? QString::number(integral)
+            : QString::number(number);
+    }
+    if (value.isBool()) {
+        return value.toBool() ? QStringLiteral("true") : QStringLiteral("false");
+    }
+    return QString();
+}
+
+int intValue(const QJsonValue &value) {
+    if (value.isDouble()) {
+        return value.toInt();
+    }
+    if (value.isString()) {
+        return value.toString().toInt();
+    }
+    return 0;
+}
+
+double doubleValue(const QJsonValue &value) {
+    if (value.isDouble()) {
+        return value.toDouble();
+    }
+    if (value.isString()) {
+        return value.toString().toDouble();
+    }
+    return 0.0;
+}
+
+#ifdef ELIXIR_HAS_SIMDJSON
+// A DOM element that may be absent, as a missing key is for QJsonValue.
+struct DomValue {
+    simdjson::dom::element element;
+    bool present = false;
+};
+
+QString toQString(std::string_view value) {
+    return QString::fromUtf8(value.data(), static_cast<qsizetype>(value.size()));
+}
+
+DomValue field(const DomValue &value, const char *key) {
+    DomValue child;
+    child.present = value.present && !value.element.at_key(key).get(child.element);
+    return child;
+}
+
+bool isString(const DomValue &value) {
+    return value.present && value.element.is_string();
+}
+
+bool isObject(const DomValue &value) {
+    return value.present && value.element.is_object();
+}
+
+template <typename Function>
+void forEachElement(const DomValue &value, Function function) {
+    if (!value.present || !value.element.is_array()) {
+        return;
+    }
+    for (simdjson::dom::element entry : value.element.get_array().value_unsafe()) {
+        function(DomValue{entry, true});
+    }
+}
+
+QString stringValue(const DomValue &value) {
+    if (!value.present) {
+        return QString();
+    }
+    const simdjson::dom::element &element = value.element;
+    switch (element.type()) {
+        case simdjson::dom::element_type::STRING:
+            return toQString(element.get_string().value_unsafe());
+        case simdjson::dom::element_type::INT64:
+            return QString::number(static_cast<qint64>(element.get_int64().value_unsafe()));
+        case simdjson::dom::element_type::UINT64:
+            return QString::number(static_cast<quint64>(element.get_uint64().value_unsafe()));
+        case simdjson::dom::element_type::DOUBLE: {
+            const double number = element.get_double().value_unsafe();
+            const qint64 integral = static_cast<qint64>(number);
+            return static_cast<double>(integral) == number
+                ? QString::number(integral)
+                : QString::number(number);
+        }
+        case simdjson::dom::element_type::BOOL:
+            return element.get_bool().value_unsafe() ? QStringLiteral("true") : QStringLiteral("false");
+        default:
+            return QString();
+    }
+}
+
+int intValue(const DomValue &value) {
+    if (!value.present) {
+        return 0;
+    }
+    const simdjson::dom::element &element = value.element;
+    switch (element.type()) {
+        case simdjson::dom::element_type::INT64:
+        case simdjson::dom::element_type::UINT64:
+        case simdjson::dom::element_type::DOUBLE: {
+            // Same contract as QJsonValue::toInt: whole numbers in range only.
+            const double number = element.get_double().value_unsafe();
+            const int integral = static_cast<int>(number);
+            return number >= std::numeric_limits<int>::min() && number <= std::numeric_limits<int>::max()
+                    && static_cast<double>(integral) == number
+                ? integral
+                : 0;
+        }
+        case simdjson::dom::element_type::STRING:
+            return toQString(element.get_string().value_unsafe()).toInt();
+        default:
+            return 0;
+    }
+}
+
+double doubleValue(const DomValue &value) {
+    if (!value.present) {
+        return 0.0;
+    }
+    const simdjson::dom::element &element = value.element;
+    if (element.is_number()) {
+        return element.get_double().value_unsafe();
+    }
+    if (element.is_string()) {
+        return toQString(element.get_string().value_unsafe()).toDouble();
+    }
+    return 0.0;
+}
+#endif
+
+qint64 epochMs(const QString &value) {
+    if (value.isEmpty()) {
+        return 0;
+    }
+    const QDateTime parsed = QDateTime::fromString(value, Qt::ISODateWithMs);
+    return parsed.isValid() ? parsed.toMSecsSinceEpoch() : 0;
+}
+
+template <typename Value>
+QString extractImage(const Value &metadata, std::initializer_list<const char *> keys) {
+    for (const char *key : keys) {
+        const Value value = field(metadata, key);
+        if (isString(value)) {
+            const QString url = stringValue(value);
+            if (!url.isEmpty()) {
+                return url;
+            }
+        } else if (isObject(value)) {
+            const QString url = stringValue(field(value, "url"));
+            if (!url.isEmpty()) {
+                return url;
+            }
+            for (const char *subKey : {"extraLarge", "large", "medium", "original", "path"}) {
+                const QString candidate = stringValue(field(value, subKey));
+                if (!candidate.isEmpty()) {
+                    return candidate;
+                }
+            }
+        }
+    }
+
+    const Value cover = field(metadata, "coverImage");
+    if (isObject(cover)) {
+        for (const char *subKey : {"extraLarge", "large", "medium", "color"}) {
+            const QString candidate = stringValue(field(cover, subKey));
+            if (!candidate.isEmpty()) {
+                return candidate;
+            }
+        }
+    }
+
+    return QString();
+}
+
+template <typename Value>
+QString extractDescription(const Value &metadata) {
+    for (const char *key : {"description", "overview", "plot", "summary"}) {
+        const QString raw = stringValue(field(metadata, key));
+        if (raw.isEmpty()) {
+            continue;
+        }
+        QString cleaned;
+        cleaned.reserve(raw.size());
+        bool inTag = false;
+        for (const QChar &ch : raw) {
+            if (ch == '<') {
+                inTag = true;
+                continue;
+            }
+            if (ch == '>') {
+                inTag = false;
+                continue;
+            }
+            if (!inTag) {
+                cleaned.append(ch);
+            }
+        }
+        return cleaned.simplified();
+    }
+    return QString();
+}
+
+template <typename Value>
+QString extractTitle(const Value &metadata) {
+    for (const char *key : {"title", "name", "original_title", "original_name"}) {
+        const QString value = stringValue(field(metadata, key));
+        if (!value.isEmpty()) {
+            return value;
+        }
+    }
+
+    const Value nested = field(metadata, "title");
+    if (isObject(nested)) {
+        for (const char *key : {"english", "romaji", "native"}) {
+            const QString value = stringValue(field(nested, key));
+            if (!value.isEmpty()) {
+                return value;
+            }
+        }
+    }
+
+    return QString();
+}
+
+template <typename Value>
+QStringList extractAlternateTitles(const Value &metadata, const QString &primary) {
+    QStringList titles;
+    auto addTitle = [&titles, &primary](const QString &value) {
+        const QString trimmed = value.trimmed();
+        if (!trimmed.isEmpty() && trimmed.compare(primary, Qt::CaseInsensitive) != 0
+            && !titles.contains(trimmed, Qt::CaseInsensitive)) {
+            titles.append(trimmed);
+        }
+    };
+
+    for (const char *key : {"title", "name", "original_title", "original_name"}) {
+        addTitle(stringValue(field(metadata, key)));
+    }
+    const Value nested = field(metadata, "title");
+    if (isObject(nested)) {
+        for (const char *key : {"english", "romaji", "native"}) {
+            addTitle(stringValue(field(nested, key)));
+        }
+    }
+    forEachElement(field(metadata, "synonyms"), [&addTitle](const Value &entry) {
+        addTitle(stringValue(entry));
+    });
+
+    return titles;
+}
+
+template <typename Value>
+int extractYear(const Value &metadata) {
+    const int metaYear = intValue(field(metadata, "year"));
+    if (metaYear > 0) {
+        return metaYear;
+    }
+
+    const QString date = stringValue(field(metadata, "release_date"));
+    if (date.size() >= 4) {
+        const int year = date.left(4).toInt();
+        if (year > 0) {
+            return year;
+        }
+    }
+
+    const QString firstAir = stringValue(field(metadata, "first_air_date"));
+    if (firstAir.size() >= 4) {
+        const int year = firstAir.left(4).toInt();
+        if (year > 0) {
+            return year;
+        }
+    }
+
+    const int startYear = intValue(field(field(metadata, "startDate"), "year"));
+    if (startYear > 0) {
+        return startYear;
+    }
+
+    return 0;
+}
+
+template <typename Value>
+QStringList extractGenres(const Value &map, const Value &metadata) {
+    QStringList genres;
+    auto addGenre = [&genres](const QString &value) {
+        const QString trimmed = value.trimmed();
+        if (!trimmed.isEmpty() && !genres.contains(trimmed)) {
+            genres.append(trimmed);
+        }
+    };
+
+    // A list of genres, or a single genre given as a plain string.
+    auto addGenres = [&addGenre](const Value &value) {
+        if (isString(value)) {
+            addGenre(stringValue(value));
+            return;
+        }
+        forEachElement(value, [&addGenre](const Value &entry) {
+            addGenre(stringValue(entry));
+        });
+    };
+
+    addGenres(field(map, "genres"));
+    if (genres.isEmpty()) {
+        addGenres(field(metadata, "genres"));
+    }
+    if (genres.isEmpty()) {
+        addGenre(stringValue(field(metadata, "genre")));
+    }
+
+    return genres;
+}
+
+template <typename Value>
+MediaItem buildItem(const Value &map, const QString &baseUrl) {
+    MediaItem item;
+    item.id = stringValue(field(map, "id"));
+    item.title = stringValue(field(map, "title"));
+    item.type = stringValue(field(map, "type"));
+    item.year = intValue(field(map, "year"));
+    item.updatedAt = stringValue(field(map, "updated_at"));
+    item.updatedAtMs = epochMs(item.updatedAt);
+    QString addedAt = stringValue(field(map, "created_at"));
+    if (addedAt.isEmpty()) {
+        addedAt = stringValue(field(map, "added_at"));
+    }
+    item.addedAtMs = epochMs(addedAt);
+    item.runtimeSeconds = intValue(field(map, "runtime_seconds"));
+    item.progress = doubleValue(field(map, "progress"));
+
+    const Value metadata = field(map, "metadata");
+    item.posterUrl = MediaItemParser::resolveUrl(stringValue(field(map, "poster_url")), baseUrl);
+    item.backdropUrl = MediaItemParser::resolveUrl(stringValue(field(map, "backdrop_url")), baseUrl);
+    const QString bannerUrl = MediaItemParser::resolveUrl(stringValue(field(map, "banner_url")), baseUrl);
+    if (item.title.trimmed().isEmpty()) {
+        item.title = extractTitle(metadata);
+    }
+    item.alternateTitles = extractAlternateTitles(metadata, item.title);
+    if (item.year <= 0) {
+        item.year = extractYear(metadata);
+    }
+    if (item.posterUrl.isEmpty()) {
+        item.posterUrl = MediaItemParser::resolveUrl(
+            extractImage(metadata, {"poster", "posterUrl", "poster_url", "poster_path", "cover", "image"}), baseUrl);
+    }
+    if (item.backdropUrl.isEmpty()) {
+        item.backdropUrl = MediaItemParser::resolveUrl(
+            extractImage(metadata, {"background", "backdrop", "fanart", "backdropUrl", "backdrop_path"}), baseUrl);
+    }
+    if (item.backdropUrl.isEmpty() && !bannerUrl.isEmpty()) {
+        item.backdropUrl = bannerUrl;
+    }
+    if (item.backdropUrl.isEmpty()) {
+        item.backdropUrl = item.posterUrl;
+    }
+    item.overview = extractDescription(metadata);
+    if (item.overview.isEmpty()) {
+        item.overview = stringValue(field(map, "description"));
+        if (item.overview.isEmpty()) {
+            item.overview = stringValue(field(map, "summary"));
+        }
+    }
+    item.genres = extractGenres(map, metadata);
+
+    return item;
+}
+} // namespace
+
+MediaItem MediaItemParser::fromJson(const QJsonObject &map, const QString &baseUrl) {
+    return buildItem(QJsonValue(map), baseUrl);
+}
+
+#ifdef ELIXIR_HAS_SIMDJSON
+MediaItem MediaItemParser::fromJson(simdjson::dom::element map, const QString &baseUrl) {
+    return buildItem(DomValue{map, true}, baseUrl);
+}
+#endif
+
+MediaItem MediaItemParser::fromJson(const QByteArray &json, const QString &baseUrl, bool *ok) {
+#ifdef ELIXIR_HAS_SIMDJSON
+    simdjson::dom::element root;
+    if (JsonBackend::parseDom(json, &root)) {
+        const bool valid = root.is_object();
+        if (ok) {
+            *ok = valid;
+        }
+        return valid ? fromJson(root, baseUrl) : MediaItem();
+    }
+#endif
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    const bool valid = parseError.error == QJsonParseError::NoError && doc.isObject();
+    if (ok) {
+        *ok = valid;
+    }
+    return valid ? fromJson(doc.object(), baseUrl) : MediaItem();
+}
+
+QString MediaItemParser::resolveUrl(const QString &value, const QString &baseUrl) {
+    const QString trimmed = value.trimmed();
+    if (trimmed.isEmpty()) {
+        return QString();
+    }
+    const QUrl url(trimmed);
+    if (!url.isRelative() || baseUrl.trimmed().isEmpty()) {
+        return trimmed;
+    }
+    const QUrl base(baseUrl);
+    if (!base.isValid()) {
+        return trimmed;
+    }
+    return base.resolved(QUrl(trimmed)).toString();
+}
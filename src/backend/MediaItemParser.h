@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+#include "backend/MediaItem.h"
+
+#ifdef ELIXIR_HAS_SIMDJSON
+#include <simdjson.h>
+#endif
+
+namespace MediaItemParser {
+    MediaItem fromJson(const QJsonObject &map, const QString &baseUrl);
+#ifdef ELIXIR_HAS_SIMDJSON
+    MediaItem fromJson(simdjson::dom::element map, const QString &baseUrl);
+#endif
+    // Builds straight from the simdjson DOM when the build has it.
+    MediaItem fromJson(const QByteArray &json, const QString &baseUrl, bool *ok = nullptr);
+    QString resolveUrl(const QString &value, const QString &baseUrl);
+}
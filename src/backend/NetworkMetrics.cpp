@@ -0,0 +1,244 @@
+#include "backend/NetworkMetrics.h"
+
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+namespace {
+constexpr qint64 kBucketBoundsMs[] = {5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+constexpr int kUpdateThrottleMs = 1000;
+
+QString promLabel(const QString &value) {
+    QString escaped = value;
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return escaped;
+}
+} // namespace
+
+void NetworkMetrics::Histogram::add(qint64 ms) {
+    int bucket = 0;
+    while (bucket < kBucketCount - 1 && ms > kBucketBoundsMs[bucket]) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+    ++count;
+    sum += ms;
+    max = qMax(max, ms);
+}
+
+qint64 NetworkMetrics::Histogram::percentile(double quantile) const {
+    if (count == 0) {
+        return 0;
+    }
+    const quint64 rank = static_cast<quint64>(quantile * static_cast<double>(count - 1)) + 1;
+    quint64 seen = 0;
+    for (int i = 0; i < kBucketCount - 1; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return qMin(kBucketBoundsMs[i], max);
+        }
+    }
+    return max;
+}
+
+NetworkMetrics::NetworkMetrics(QObject *parent)
+    : QObject(parent) {
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(kUpdateThrottleMs);
+    connect(&m_updateTimer, &QTimer::timeout, this, &NetworkMetrics::updated);
+    connect(&m_dumpTimer, &QTimer::timeout, this, &NetworkMetrics::dumpNow);
+}
+
+QString NetworkMetrics::endpointTemplate(const QString &method, const QUrl &url) {
+    static const QRegularExpression version("^v\\d+$");
+    static const QRegularExpression digit("\\d");
+    QStringList segments = url.path().split('/');
+    for (QString &segment : segments) {
+        if (!version.match(segment).hasMatch() && (segment.contains(digit) || segment.size() >= 24)) {
+            segment = ":id";
+        }
+    }
+    return QString("%1 %2").arg(method, segments.join('/'));
+}
+
+NetworkMetrics::EndpointStats &NetworkMetrics::statsFor(const QString &endpoint, const QString &route) {
+    const QString key = endpoint + '\n' + route;
+    auto it = m_stats.find(key);
+    if (it == m_stats.end()) {
+        it = m_stats.insert(key, EndpointStats());
+        it->endpoint = endpoint;
+        it->route = route;
+    }
+    return it.value();
+}
+
+void NetworkMetrics::recordRequest(const QString &endpoint, const QString &route, const Timings &timings) {
+    EndpointStats &stats = statsFor(endpoint, route);
+    ++stats.requests;
+    if (timings.error) {
+        ++stats.errors;
+    }
+    stats.bytes += timings.bytes;
+    if (timings.connectMs >= 0) {
+        stats.connect.add(timings.connectMs);
+    }
+    if (timings.ttfbMs >= 0) {
+        stats.ttfb.add(timings.ttfbMs);
+    }
+    stats.total.add(timings.totalMs);
+    scheduleUpdate();
+}
+
+void NetworkMetrics::recordParse(const QString &endpoint, const QString &route, qint64 elapsedMs) {
+    statsFor(endpoint, route).parse.add(elapsedMs);
+    scheduleUpdate();
+}
+
+void NetworkMetrics::scheduleUpdate() {
+    if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
+}
+
+QVariantList NetworkMetrics::endpoints() const {
+    QVariantList result;
+    for (const EndpointStats &stats : m_stats) {
+        result.append(QVariantMap{
+            {"endpoint", stats.endpoint},
+            {"route", stats.route},
+            {"requests", stats.requests},
+            {"errors", stats.errors},
+            {"bytes", stats.bytes},
+            {"connectP50", stats.connect.percentile(0.5)},
+            {"ttfbP50", stats.ttfb.percentile(0.5)},
+            {"totalP50", stats.total.percentile(0.5)},
+            {"totalP90", stats.total.percentile(0.9)},
+            {"totalP99", stats.total.percentile(0.99)},
+            {"parseP50", stats.parse.percentile(0.5)},
+            {"parseP99", stats.parse.percentile(0.99)},
+        });
+    }
+    return result;
+}
+
+int NetworkMetrics::dumpIntervalSeconds() const {
+    return m_dumpIntervalSeconds;
+}
+
+void NetworkMetrics::setDumpIntervalSeconds(int value) {
+    value = qMax(0, value);
+    if (m_dumpIntervalSeconds == value) {
+        return;
+    }
+    m_dumpIntervalSeconds = value;
+    if (value > 0) {
+        m_dumpTimer.start(value * 1000);
+    } else {
+        m_dumpTimer.stop();
+    }
+    emit dumpIntervalSecondsChanged();
+}
+
+QString NetworkMetrics::dumpDirectory() const {
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+}
+
+bool NetworkMetrics::dumpNow() {
+    const QString dir = dumpDirectory();
+    if (dir.isEmpty() || !QDir().mkpath(dir)) {
+        return false;
+    }
+    bool ok = true;
+    const QList<QPair<QString, QByteArray>> files = {
+        {"network-metrics.json", toJson()},
+        {"network-metrics.prom", toPrometheus()},
+    };
+    for (const auto &file : files) {
+        QSaveFile out(QDir(dir).filePath(file.first));
+        if (!out.open(QIODevice::WriteOnly)) {
+            ok = false;
+            continue;
+        }
+        out.write(file.second);
+        ok = out.commit() && ok;
+    }
+    return ok;
+}
+
+void NetworkMetrics::reset() {
+    m_stats.clear();
+    emit updated();
+}
+
+QByteArray NetworkMetrics::toJson() const {
+    auto histogramJson = [](const Histogram &histogram) {
+        return QJsonObject{
+            {"count", static_cast<qint64>(histogram.count)},
+            {"sum", histogram.sum},
+            {"max", histogram.max},
+            {"p50", histogram.percentile(0.5)},
+            {"p90", histogram.percentile(0.9)},
+            {"p99", histogram.percentile(0.99)},
+        };
+    };
+    QJsonArray endpoints;
+    for (const EndpointStats &stats : m_stats) {
+        endpoints.append(QJsonObject{
+            {"endpoint", stats.endpoint},
+            {"route", stats.route},
+            {"requests", static_cast<qint64>(stats.requests)},
+            {"errors", static_cast<qint64>(stats.errors)},
+            {"bytes", stats.bytes},
+            {"connect_ms", histogramJson(stats.connect)},
+            {"ttfb_ms", histogramJson(stats.ttfb)},
+            {"total_ms", histogramJson(stats.total)},
+            {"parse_ms", histogramJson(stats.parse)},
+        });
+    }
+    return QJsonDocument(QJsonObject{{"endpoints", endpoints}}).toJson();
+}
+
+QByteArray NetworkMetrics::toPrometheus() const {
+    QByteArray out;
+    auto writeHistogram = [&out, this](const char *name, const Histogram EndpointStats::*member) {
+        out += QByteArray("# TYPE elixir_http_") + name + "_ms histogram\n";
+        for (const EndpointStats &stats : m_stats) {
+            const Histogram &histogram = stats.*member;
+            if (histogram.count == 0) {
+                continue;
+            }
+            const QByteArray labels = QString("endpoint=\"%1\",route=\"%2\"")
+                .arg(promLabel(stats.endpoint), promLabel(stats.route)).toUtf8();
+            quint64 cumulative = 0;
+            for (int i = 0; i < kBucketCount; ++i) {
+                cumulative += histogram.buckets[i];
+                const QByteArray le = i < kBucketCount - 1 ? QByteArray::number(kBucketBoundsMs[i]) : QByteArray("+Inf");
+                out += QByteArray("elixir_http_") + name + "_ms_bucket{" + labels + ",le=\"" + le + "\"} "
+                    + QByteArray::number(cumulative) + '\n';
+            }
+            out += QByteArray("elixir_http_") + name + "_ms_sum{" + labels + "} " + QByteArray::number(histogram.sum) + '\n';
+            out += QByteArray("elixir_http_") + name + "_ms_count{" + labels + "} " + QByteArray::number(histogram.count) + '\n';
+        }
+    };
+    auto writeCounter = [&out, this](const char *name, auto value) {
+        out += QByteArray("# TYPE elixir_http_") + name + " counter\n";
+        for (const EndpointStats &stats : m_stats) {
+            out += QByteArray("elixir_http_") + name + "{endpoint=\"" + promLabel(stats.endpoint).toUtf8()
+                + "\",route=\"" + promLabel(stats.route).toUtf8() + "\"} " + QByteArray::number(value(stats)) + '\n';
+        }
+    };
+
+    writeCounter("requests_total", [](const EndpointStats &stats) { return stats.requests; });
+    writeCounter("errors_total", [](const EndpointStats &stats) { return stats.errors; });
+    writeCounter("received_bytes_total", [](const EndpointStats &stats) { return stats.bytes; });
+    writeHistogram("connect", &EndpointStats::connect);
+    writeHistogram("ttfb", &EndpointStats::ttfb);
+    writeHistogram("total", &EndpointStats::total);
+    writeHistogram("parse", &EndpointStats::parse);
+    return out;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+#include <QVariantList>
+
+class NetworkMetrics : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantList endpoints READ endpoints NOTIFY updated)
+    Q_PROPERTY(int dumpIntervalSeconds READ dumpIntervalSeconds WRITE setDumpIntervalSeconds NOTIFY dumpIntervalSecondsChanged)
+    Q_PROPERTY(QString dumpDirectory READ dumpDirectory CONSTANT)
+
+public:
+    struct Timings {
+        qint64 connectMs = -1;
+        qint64 ttfbMs = -1;
+        qint64 totalMs = 0;
+        qint64 bytes = 0;
+        bool error = false;
+    };
+
+    explicit NetworkMetrics(QObject *parent = nullptr);
+
+    static QString endpointTemplate(const QString &method, const QUrl &url);
+
+    void recordRequest(const QString &endpoint, const QString &route, const Timings &timings);
+    void recordParse(const QString &endpoint, const QString &route, qint64 elapsedMs);
+
+    QVariantList endpoints() const;
+
+    int dumpIntervalSeconds() const;
+    void setDumpIntervalSeconds(int value);
+
+    QString dumpDirectory() const;
+
+    Q_INVOKABLE bool dumpNow();
+    Q_INVOKABLE void reset();
+
+    QByteArray toJson() const;
+    QByteArray toPrometheus() const;
+
+signals:
+    void updated();
+    void dumpIntervalSecondsChanged();
+
+private:
+    static constexpr int kBucketCount = 12;
+
+    struct Histogram {
+        quint64 buckets[kBucketCount] = {};
+        quint64 count = 0;
+        qint64 sum = 0;
+        qint64 max = 0;
+
+        void add(qint64 ms);
+        qint64 percentile(double quantile) const;
+    };
+
+    struct EndpointStats {
+        QString endpoint;
+        QString route;
+        quint64 requests = 0;
+        quint64 errors = 0;
+        qint64 bytes = 0;
+        Histogram connect;
+        Histogram ttfb;
+        Histogram total;
+        Histogram parse;
+    };
+
+    EndpointStats &statsFor(const QString &endpoint, const QString &route);
+    void scheduleUpdate();
+
+    QMap<QString, EndpointStats> m_stats;
+    QTimer m_updateTimer;
+    QTimer m_dumpTimer;
+    int m_dumpIntervalSeconds = 0;
+};
@@ -1,6 +1,8 @@
 #include "backend/PlayerController.h"
 
 #include "backend/ApiClient.h"
+#include "backend/Logging.h"
+#include "backend/TraceRecorder.h"
 
 #include <QDateTime>
 #include <QUrl>
@@ -91,9 +93,10 @@ bool PlayerController::active() const {
 }
 
 void PlayerController::beginPlayback(const QVariantMap &info) {
+    TraceSpan span("begin playback", "player");
     const QString baseUrl = m_apiClient ? m_apiClient->baseUrl() : QString();
     const QString path = info.value("stream_url").toString();
-    qInfo() << "Playback start"
+    qCInfo(lcPlayer) << "Playback start"
             << "session" << info.value("session_id").toString()
             << "mode" << info.value("mode").toString()
             << "stream" << sanitizeUrlForLog(path)
@@ -111,6 +114,7 @@ void PlayerController::beginPlayback(const QVariantMap &info) {
     m_seekInFlight = false;
     m_pendingSeekSeconds = 0.0;
     m_pendingStreamUrl.clear();
+    beginTraceSpan("first frame");
 }
 
 void PlayerController::applySessionPoll(const QVariantMap &info) {
@@ -125,7 +129,7 @@ void PlayerController::applySessionPoll(const QVariantMap &info) {
     const QString state = info.value("state").toString();
     if (!state.isEmpty()) {
         if (state != m_sessionState) {
-            qInfo() << "Session state update" << state;
+            qCInfo(lcPlayer) << "Session state update" << state;
         }
         setSessionState(state);
     }
@@ -133,7 +137,7 @@ void PlayerController::applySessionPoll(const QVariantMap &info) {
     const QString error = info.value("error").toString();
     if (error != m_sessionError) {
         if (!error.isEmpty()) {
-            qWarning() << "Session error" << error;
+            qCWarning(lcPlayer) << "Session error" << error;
         }
         setSessionError(error);
     }
@@ -161,6 +165,9 @@ void PlayerController::updateLocalPosition(double seconds) {
     if (!std::isfinite(seconds)) {
         return;
     }
+    if (m_pendingTraceSpan && seconds > 0.0) {
+        endTraceSpan();
+    }
     setLocalPositionInternal(seconds);
 }
 
@@ -176,12 +183,14 @@ void PlayerController::seek(double seconds) {
     if (!m_active || m_sessionId.isEmpty()) {
         return;
     }
+    TraceSpan span("seek", "player");
+    beginTraceSpan("seek to frame");
     if (m_mode == "transcode") {
         if (m_apiClient) {
             m_pendingSeekSeconds = seconds;
             m_pendingStreamUrl = cacheBustUrl(m_streamUrl);
             m_seekInFlight = true;
-            qInfo() << "Seek request" << m_sessionId << seconds;
+            qCInfo(lcPlayer) << "Seek request" << m_sessionId << seconds;
             m_apiClient->seekPlayback(m_sessionId, seconds);
         }
         setSeekOffsetInternal(seconds);
@@ -194,13 +203,14 @@ void PlayerController::seek(double seconds) {
 
 void PlayerController::endSession() {
     if (m_apiClient && !m_sessionId.isEmpty()) {
-        qInfo() << "Ending session" << m_sessionId;
+        qCInfo(lcPlayer) << "Ending session" << m_sessionId;
         m_apiClient->endSession(m_sessionId);
     }
     reset();
 }
 
 void PlayerController::reset() {
+    endTraceSpan();
     setActive(false);
     setSessionId(QString());
     setMode(QString());
@@ -216,12 +226,26 @@ void PlayerController::reset() {
     m_pendingStreamUrl.clear();
 }
 
+void PlayerController::beginTraceSpan(const char *name) {
+    endTraceSpan();
+    m_pendingTraceSpan = name;
+    TraceRecorder::asyncBegin(name, "player", ++m_traceId, m_sessionId);
+}
+
+void PlayerController::endTraceSpan() {
+    if (!m_pendingTraceSpan) {
+        return;
+    }
+    TraceRecorder::asyncEnd(m_pendingTraceSpan, "player", m_traceId);
+    m_pendingTraceSpan = nullptr;
+}
+
 void PlayerController::setStreamUrl(const QString &value) {
     if (m_streamUrl == value) {
         return;
     }
     m_streamUrl = value;
-    qInfo() << "Stream URL updated" << sanitizeUrlForLog(value);
+    qCInfo(lcPlayer) << "Stream URL updated" << sanitizeUrlForLog(value);
     emit streamUrlChanged();
 }
 
@@ -299,7 +323,7 @@ void PlayerController::handleSeekCompleted(const QString &sessionId, double seco
         return;
     }
     m_seekInFlight = false;
-    qInfo() << "Seek completed" << sessionId << seconds;
+    qCInfo(lcPlayer) << "Seek completed" << sessionId << seconds;
     setStreamUrl(m_pendingStreamUrl);
 }
 
@@ -308,7 +332,7 @@ void PlayerController::handleSeekFailed(const QString &sessionId, const QString
         return;
     }
     m_seekInFlight = false;
-    qWarning() << "Seek failed" << sessionId << error;
+    qCWarning(lcPlayer) << "Seek failed" << sessionId << error;
     if (!error.isEmpty()) {
         setSessionError(error);
     }
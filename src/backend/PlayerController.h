@@ -71,6 +71,8 @@ private:
     void setLocalPositionInternal(double value);
     void setSeekOffsetInternal(double value);
     void setActive(bool value);
+    void beginTraceSpan(const char *name);
+    void endTraceSpan();
 
     QString buildStreamUrl(const QString &baseUrl, const QString &path) const;
     QString cacheBustUrl(const QString &url) const;
@@ -89,4 +91,6 @@ private:
     bool m_seekInFlight = false;
     double m_pendingSeekSeconds = 0.0;
     QString m_pendingStreamUrl;
+    quint64 m_traceId = 0;
+    const char *m_pendingTraceSpan = nullptr;
 };
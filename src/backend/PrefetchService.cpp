@@ -0,0 +1,111 @@
+#include "backend/PrefetchService.h"
+
+#include "backend/ApiClient.h"
+
+#include <utility>
+
+namespace {
+constexpr int kIntentDelayMs = 250;
+constexpr double kBurstTokens = 3.0;
+constexpr double kTokensPerSecond = 0.5;
+} // namespace
+
+PrefetchService::PrefetchService(ApiClient *apiClient, QObject *parent)
+    : QObject(parent),
+      m_apiClient(apiClient),
+      m_tokens(kBurstTokens) {
+    m_intentTimer.setSingleShot(true);
+    m_intentTimer.setInterval(kIntentDelayMs);
+    connect(&m_intentTimer, &QTimer::timeout, this, &PrefetchService::startPrefetch);
+    m_refillClock.start();
+}
+
+QString PrefetchService::activeMediaId() const {
+    return m_activeMediaId;
+}
+
+void PrefetchService::hoverStarted(const QString &mediaId, const QString &type) {
+    if (mediaId.isEmpty() || mediaId == m_activeMediaId) {
+        return;
+    }
+    cancelPrefetch();
+    m_candidateId = mediaId;
+    m_candidateType = type;
+    m_intentTimer.start();
+}
+
+void PrefetchService::hoverEnded(const QString &mediaId) {
+    if (mediaId == m_candidateId) {
+        m_intentTimer.stop();
+        m_candidateId.clear();
+    }
+    if (mediaId == m_activeMediaId) {
+        cancelPrefetch();
+    }
+}
+
+void PrefetchService::startPrefetch() {
+    const QString mediaId = std::exchange(m_candidateId, QString());
+    if (mediaId.isEmpty() || !takeToken()) {
+        return;
+    }
+    setActiveMediaId(mediaId);
+
+    if (const int id = m_apiClient->warmMediaDetails(mediaId)) {
+        m_requestIds.append(id);
+    }
+    if (m_candidateType != "series" && m_candidateType != "anime") {
+        return;
+    }
+    const quint64 generation = ++m_generation;
+    const int seasonsId = m_apiClient->warmSeasons(mediaId, [this, generation](const QVariantList &seasons) {
+        if (generation != m_generation || seasons.isEmpty()) {
+            return;
+        }
+        // Same choice DetailsView makes: the first season with files.
+        QString seasonId = seasons.first().toMap().value("id").toString();
+        for (const QVariant &season : seasons) {
+            const QVariantMap map = season.toMap();
+            if (map.value("has_files").toBool()) {
+                seasonId = map.value("id").toString();
+                break;
+            }
+        }
+        if (const int id = m_apiClient->warmSeasonDetail(seasonId)) {
+            m_requestIds.append(id);
+        }
+        if (const int id = m_apiClient->warmEpisodes(seasonId)) {
+            m_requestIds.append(id);
+        }
+    });
+    if (seasonsId) {
+        m_requestIds.append(seasonsId);
+    }
+}
+
+void PrefetchService::cancelPrefetch() {
+    ++m_generation;
+    for (const int id : std::exchange(m_requestIds, QVector<int>())) {
+        m_apiClient->cancelRequest(id);
+    }
+    setActiveMediaId(QString());
+}
+
+bool PrefetchService::takeToken() {
+    // Token bucket: a quick sweep across a row spends the burst and then
+    // only gets one prefetch every couple of seconds.
+    m_tokens = qMin(kBurstTokens, m_tokens + m_refillClock.restart() / 1000.0 * kTokensPerSecond);
+    if (m_tokens < 1.0) {
+        return false;
+    }
+    m_tokens -= 1.0;
+    return true;
+}
+
+void PrefetchService::setActiveMediaId(const QString &value) {
+    if (m_activeMediaId == value) {
+        return;
+    }
+    m_activeMediaId = value;
+    emit activeMediaIdChanged();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+class ApiClient;
+
+// Warms details, seasons and artwork for the card the user is hovering or
+// focusing, once the intent has lasted long enough and budget allows.
+class PrefetchService : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QString activeMediaId READ activeMediaId NOTIFY activeMediaIdChanged)
+
+public:
+    explicit PrefetchService(ApiClient *apiClient, QObject *parent = nullptr);
+
+    QString activeMediaId() const;
+
+    Q_INVOKABLE void hoverStarted(const QString &mediaId, const QString &type);
+    Q_INVOKABLE void hoverEnded(const QString &mediaId);
+
+signals:
+    void activeMediaIdChanged();
+
+private:
+    void startPrefetch();
+    void cancelPrefetch();
+    bool takeToken();
+    void setActiveMediaId(const QString &value);
+
+    ApiClient *m_apiClient = nullptr;
+    QTimer m_intentTimer;
+    QString m_candidateId;
+    QString m_candidateType;
+    QString m_activeMediaId;
+    QVector<int> m_requestIds;
+    quint64 m_generation = 0;
+    double m_tokens = 0.0;
+    QElapsedTimer m_refillClock;
+};
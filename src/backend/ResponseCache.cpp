@@ -0,0 +1,224 @@
+#include "backend/ResponseCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace {
+constexpr quint32 kCacheMagic = 0x454c5852;
+constexpr quint16 kCacheVersion = 1;
+constexpr int kDocumentCacheKb = 32 * 1024;
+
+bool readHeader(QFile &file, ResponseCache::Validators *validators) {
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != kCacheMagic || version != kCacheVersion) {
+        return false;
+    }
+    in >> validators->etag >> validators->lastModified;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    validators->valid = !validators->etag.isEmpty() || !validators->lastModified.isEmpty();
+    return validators->valid;
+}
+} // namespace
+
+ResponseCache::ResponseCache(qint64 maximumBytes)
+    : m_maximumBytes(maximumBytes),
+      m_documents(kDocumentCacheKb) {}
+
+QString ResponseCache::directory() const {
+    return m_directory;
+}
+
+void ResponseCache::setDirectory(const QString &path) {
+    if (m_directory == path) {
+        return;
+    }
+    m_directory = path;
+    m_documents.clear();
+    m_totalBytes = 0;
+    if (m_directory.isEmpty()) {
+        return;
+    }
+    QDir dir(m_directory);
+    dir.mkpath(".");
+    const QFileInfoList files = dir.entryInfoList({"*.cache"}, QDir::Files);
+    for (const QFileInfo &info : files) {
+        m_totalBytes += info.size();
+    }
+    trim();
+}
+
+qint64 ResponseCache::maximumBytes() const {
+    return m_maximumBytes;
+}
+
+void ResponseCache::setMaximumBytes(qint64 value) {
+    m_maximumBytes = value;
+    trim();
+}
+
+ResponseCache::Validators ResponseCache::validators(const QString &key) const {
+    Validators result;
+    if (m_directory.isEmpty()) {
+        return result;
+    }
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return result;
+    }
+    if (!readHeader(file, &result)) {
+        return Validators();
+    }
+    return result;
+}
+
+QString ResponseCache::filePath(const QString &key) const {
+    if (m_directory.isEmpty()) {
+        return QString();
+    }
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QDir(m_directory).filePath(QString::fromLatin1(hash) + ".cache");
+}
+
+bool ResponseCache::cachedDocument(const QString &key, QJsonDocument *doc) const {
+    if (const QJsonDocument *cached = m_documents.object(filePath(key))) {
+        *doc = *cached;
+        return true;
+    }
+    return false;
+}
+
+bool ResponseCache::accepts(const QByteArray &etag, const QByteArray &lastModified, qint64 bytes) const {
+    return !m_directory.isEmpty() && (!etag.isEmpty() || !lastModified.isEmpty()) && bytes <= m_maximumBytes / 2;
+}
+
+void ResponseCache::remember(const QString &key, const QJsonDocument &doc, qint64 bytes) {
+    const int costKb = static_cast<int>(qMax<qint64>(1, bytes / 1024));
+    m_documents.insert(filePath(key), new QJsonDocument(doc), costKb);
+}
+
+void ResponseCache::stored(const QString &key, qint64 grownBy, const QJsonDocument &doc, qint64 bytes) {
+    m_totalBytes += grownBy;
+    remember(key, doc, bytes);
+    trim();
+}
+
+bool ResponseCache::readFile(const QString &path, QByteArray *payload) {
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+    Validators header;
+    if (!readHeader(file, &header)) {
+        return false;
+    }
+    *payload = file.readAll();
+    file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+std::optional<qint64> ResponseCache::writeFile(const QString &path, const QByteArray &etag,
+                                               const QByteArray &lastModified, const QByteArray &payload) {
+    const qint64 previousSize = QFileInfo(path).size();
+    QSaveFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::WriteOnly)) {
+        return std::nullopt;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << kCacheMagic << kCacheVersion << etag << lastModified;
+    file.write(payload);
+    if (!file.commit()) {
+        return std::nullopt;
+    }
+    return QFileInfo(path).size() - previousSize;
+}
+
+std::shared_ptr<QSaveFile> ResponseCache::beginStore(const QString &key, const QByteArray &etag,
+                                                     const QByteArray &lastModified) {
+    if (m_directory.isEmpty() || (etag.isEmpty() && lastModified.isEmpty())) {
+        return nullptr;
+    }
+    const QString path = filePath(key);
+    m_documents.remove(path);
+    auto file = std::make_shared<QSaveFile>(path);
+    if (!file->open(QIODevice::WriteOnly)) {
+        return nullptr;
+    }
+    QDataStream out(file.get());
+    out.setVersion(QDataStream::Qt_6_5);
+    out << kCacheMagic << kCacheVersion << etag << lastModified;
+    return file;
+}
+
+void ResponseCache::finishStore(const std::shared_ptr<QSaveFile> &file, bool commit) {
+    if (!file) {
+        return;
+    }
+    if (!commit || file->pos() > m_maximumBytes / 2) {
+        file->cancelWriting();
+        file->commit();
+        return;
+    }
+    const QString path = file->fileName();
+    const qint64 previousSize = QFileInfo(path).size();
+    if (!file->commit()) {
+        return;
+    }
+    m_totalBytes += QFileInfo(path).size() - previousSize;
+    trim();
+}
+
+void ResponseCache::remove(const QString &key) {
+    if (m_directory.isEmpty()) {
+        return;
+    }
+    const QString path = filePath(key);
+    m_documents.remove(path);
+    const qint64 size = QFileInfo(path).size();
+    if (QFile::remove(path)) {
+        m_totalBytes -= size;
+    }
+}
+
+void ResponseCache::clear() {
+    m_documents.clear();
+    if (m_directory.isEmpty()) {
+        return;
+    }
+    QDir dir(m_directory);
+    const QStringList files = dir.entryList({"*.cache"}, QDir::Files);
+    for (const QString &name : files) {
+        dir.remove(name);
+    }
+    m_totalBytes = 0;
+}
+
+void ResponseCache::trim() {
+    if (m_directory.isEmpty() || m_totalBytes <= m_maximumBytes) {
+        return;
+    }
+    const qint64 target = m_maximumBytes - m_maximumBytes / 10;
+    QDir dir(m_directory);
+    const QFileInfoList files = dir.entryInfoList({"*.cache"}, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &info : files) {
+        if (m_totalBytes <= target) {
+            break;
+        }
+        const qint64 size = info.size();
+        m_documents.remove(info.absoluteFilePath());
+        if (QFile::remove(info.absoluteFilePath())) {
+            m_totalBytes -= size;
+        }
+    }
+}
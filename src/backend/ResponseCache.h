@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QByteArray>
+#include <QCache>
+#include <QJsonDocument>
+#include <QString>
+#include <memory>
+#include <optional>
+
+class QSaveFile;
+
+// Conditional-request cache on disk, with recently used documents kept
+// parsed in memory. Bookkeeping belongs to the owning thread; the static
+// file functions can run on any thread, with the caller reporting the
+// outcome back through remember(), stored() or remove().
+class ResponseCache {
+public:
+    struct Validators {
+        QByteArray etag;
+        QByteArray lastModified;
+        bool valid = false;
+    };
+
+    explicit ResponseCache(qint64 maximumBytes = 64 * 1024 * 1024);
+
+    QString directory() const;
+    void setDirectory(const QString &path);
+
+    qint64 maximumBytes() const;
+    void setMaximumBytes(qint64 value);
+
+    Validators validators(const QString &key) const;
+    QString filePath(const QString &key) const;
+    // The parsed document if it is still held in memory.
+    bool cachedDocument(const QString &key, QJsonDocument *doc) const;
+    bool accepts(const QByteArray &etag, const QByteArray &lastModified, qint64 bytes) const;
+    void remember(const QString &key, const QJsonDocument &doc, qint64 bytes);
+    void stored(const QString &key, qint64 grownBy, const QJsonDocument &doc, qint64 bytes);
+
+    // Reads the payload after a valid header and marks the file as used.
+    static bool readFile(const QString &path, QByteArray *payload);
+    // Writes the file; returns how much it grew the cache, or nothing if it
+    // could not be written.
+    static std::optional<qint64> writeFile(const QString &path, const QByteArray &etag,
+                                           const QByteArray &lastModified, const QByteArray &payload);
+    std::shared_ptr<QSaveFile> beginStore(const QString &key, const QByteArray &etag, const QByteArray &lastModified);
+    void finishStore(const std::shared_ptr<QSaveFile> &file, bool commit);
+    void remove(const QString &key);
+    void clear();
+
+private:
+    void trim();
+
+    QString m_directory;
+    qint64 m_maximumBytes = 0;
+    qint64 m_totalBytes = 0;
+    QCache<QString, QJsonDocument> m_documents;
+};
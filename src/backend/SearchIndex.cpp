@@ -0,0 +1,401 @@
+#include "backend/SearchIndex.h"
+
+#include <QPair>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+namespace {
+// Trigram overlap only shortlists; this many best candidates get scored.
+constexpr int kMaxFuzzyCandidates = 2000;
+// Terms up to this long are matched anywhere in a token. Finding them means
+// scanning the whole vocabulary, which is still far smaller than the items.
+constexpr qsizetype kMaxInfixTermLength = 4;
+
+quint64 trigramKey(const QString &text, qsizetype at) {
+    return (quint64(text.at(at).unicode()) << 32) | (quint64(text.at(at + 1).unicode()) << 16)
+        | quint64(text.at(at + 2).unicode());
+}
+
+void appendTrigrams(const QString &token, bool closed, QVector<quint64> *grams) {
+    const QString padded = QLatin1Char(' ') + token + (closed ? QStringLiteral(" ") : QString());
+    for (qsizetype i = 0; i + 2 < padded.size(); ++i) {
+        grams->append(trigramKey(padded, i));
+    }
+}
+
+QVector<quint64> titleTrigrams(const QVector<QStringList> &titles) {
+    QVector<quint64> grams;
+    for (const QStringList &tokens : titles) {
+        for (const QString &token : tokens) {
+            appendTrigrams(token, true, &grams);
+        }
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+int maxEditsFor(const QString &term) {
+    if (term.size() < 3) {
+        return 0;
+    }
+    return term.size() < 6 ? 1 : 2;
+}
+
+// Optimal string alignment distance, giving up as soon as it exceeds bound.
+int boundedDistance(const QString &left, const QString &right, int bound) {
+    const qsizetype n = left.size();
+    const qsizetype m = right.size();
+    if (qAbs(n - m) > bound) {
+        return bound + 1;
+    }
+    QVector<int> before(m + 1);
+    QVector<int> previous(m + 1);
+    QVector<int> current(m + 1);
+    std::iota(previous.begin(), previous.end(), 0);
+    for (qsizetype i = 1; i <= n; ++i) {
+        current[0] = int(i);
+        int rowMin = current[0];
+        for (qsizetype j = 1; j <= m; ++j) {
+            const int cost = left.at(i - 1) == right.at(j - 1) ? 0 : 1;
+            int value = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+            if (i > 1 && j > 1 && left.at(i - 1) == right.at(j - 2) && left.at(i - 2) == right.at(j - 1)) {
+                value = std::min(value, before[j - 2] + 1);
+            }
+            current[j] = value;
+            rowMin = std::min(rowMin, value);
+        }
+        if (rowMin > bound) {
+            return bound + 1;
+        }
+        std::swap(before, previous);
+        std::swap(previous, current);
+    }
+    return std::min(previous[m], bound + 1);
+}
+
+// A term also matches the start of a longer token, so partially typed words
+// still score.
+int termDistance(const QString &term, const QString &token, int bound) {
+    if (token.startsWith(term)) {
+        return 0;
+    }
+    int distance = boundedDistance(term, token, bound);
+    if (distance > 0 && term.size() >= 3 && token.size() > term.size()) {
+        distance = std::min(distance, boundedDistance(term, token.left(term.size()), bound));
+    }
+    return distance;
+}
+} // namespace
+
+QString SearchIndex::fold(const QString &text) {
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString stripped;
+    stripped.reserve(decomposed.size());
+    for (const QChar &ch : decomposed) {
+        if (ch.category() != QChar::Mark_NonSpacing) {
+            stripped.append(ch);
+        }
+    }
+    return stripped.toCaseFolded();
+}
+
+QStringList SearchIndex::tokenize(const QString &text) {
+    QStringList tokens;
+    const QString folded = fold(text);
+    qsizetype start = -1;
+    for (qsizetype i = 0; i <= folded.size(); ++i) {
+        const bool word = i < folded.size() && folded.at(i).isLetterOrNumber();
+        if (word && start < 0) {
+            start = i;
+        } else if (!word && start >= 0) {
+            tokens.append(folded.mid(start, i - start));
+            start = -1;
+        }
+    }
+    return tokens;
+}
+
+void SearchIndex::clear() {
+    m_postings.clear();
+    m_docById.clear();
+    m_ids.clear();
+    m_docTokens.clear();
+    m_trigrams.clear();
+    m_docTitles.clear();
+    m_freeDocs.clear();
+}
+
+void SearchIndex::insert(const MediaItem &item) {
+    if (item.id.isEmpty()) {
+        return;
+    }
+    remove(item.id);
+
+    QVector<QStringList> titles;
+    titles.reserve(1 + item.alternateTitles.size());
+    titles.append(tokenize(item.title));
+    for (const QString &title : item.alternateTitles) {
+        titles.append(tokenize(title));
+    }
+
+    QStringList tokens;
+    for (const QStringList &titleTokens : std::as_const(titles)) {
+        tokens += titleTokens;
+    }
+    tokens += tokenize(item.overview);
+    for (const QString &genre : item.genres) {
+        tokens += tokenize(genre);
+    }
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    int doc = 0;
+    if (!m_freeDocs.isEmpty()) {
+        doc = m_freeDocs.takeLast();
+        m_ids[doc] = item.id;
+        m_docTokens[doc] = tokens;
+        m_docTitles[doc] = titles;
+    } else {
+        doc = m_ids.size();
+        m_ids.append(item.id);
+        m_docTokens.append(tokens);
+        m_docTitles.append(titles);
+    }
+    m_docById.insert(item.id, doc);
+
+    for (const QString &token : tokens) {
+        QVector<int> &docs = m_postings[token];
+        docs.insert(std::lower_bound(docs.begin(), docs.end(), doc), doc);
+    }
+    for (const quint64 gram : titleTrigrams(titles)) {
+        QVector<int> &docs = m_trigrams[gram];
+        docs.insert(std::lower_bound(docs.begin(), docs.end(), doc), doc);
+    }
+}
+
+void SearchIndex::remove(const QString &id) {
+    const auto it = m_docById.constFind(id);
+    if (it == m_docById.constEnd()) {
+        return;
+    }
+    const int doc = it.value();
+    m_docById.erase(it);
+
+    for (const QString &token : std::as_const(m_docTokens.at(doc))) {
+        const auto posting = m_postings.find(token);
+        if (posting == m_postings.end()) {
+            continue;
+        }
+        QVector<int> &docs = posting.value();
+        const auto found = std::lower_bound(docs.begin(), docs.end(), doc);
+        if (found != docs.end() && *found == doc) {
+            docs.erase(found);
+        }
+        if (docs.isEmpty()) {
+            m_postings.erase(posting);
+        }
+    }
+    for (const quint64 gram : titleTrigrams(m_docTitles.at(doc))) {
+        const auto posting = m_trigrams.find(gram);
+        if (posting == m_trigrams.end()) {
+            continue;
+        }
+        QVector<int> &docs = posting.value();
+        const auto found = std::lower_bound(docs.begin(), docs.end(), doc);
+        if (found != docs.end() && *found == doc) {
+            docs.erase(found);
+        }
+        if (docs.isEmpty()) {
+            m_trigrams.erase(posting);
+        }
+    }
+    m_ids[doc].clear();
+    m_docTokens[doc].clear();
+    m_docTitles[doc].clear();
+    m_freeDocs.append(doc);
+}
+
+QStringList SearchIndex::search(const QString &query) const {
+    QStringList terms = tokenize(query);
+    if (terms.isEmpty()) {
+        return {};
+    }
+    terms.removeDuplicates();
+
+    // Intersect the narrowest candidate sets first.
+    QVector<QVector<int>> candidates;
+    candidates.reserve(terms.size());
+    for (const QString &term : std::as_const(terms)) {
+        QVector<int> docs = docsForTerm(term);
+        if (docs.isEmpty()) {
+            return {};
+        }
+        candidates.append(std::move(docs));
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const QVector<int> &left, const QVector<int> &right) {
+        return left.size() < right.size();
+    });
+
+    QVector<int> matches = candidates.takeFirst();
+    for (const QVector<int> &docs : std::as_const(candidates)) {
+        QVector<int> narrowed;
+        narrowed.reserve(matches.size());
+        std::set_intersection(matches.cbegin(), matches.cend(), docs.cbegin(), docs.cend(),
+                              std::back_inserter(narrowed));
+        matches = std::move(narrowed);
+        if (matches.isEmpty()) {
+            return {};
+        }
+    }
+
+    QStringList ids;
+    ids.reserve(matches.size());
+    for (const int doc : std::as_const(matches)) {
+        ids.append(m_ids.at(doc));
+    }
+    return ids;
+}
+
+QVector<SearchIndex::Match> SearchIndex::rankedSearch(const QString &query, int limit) const {
+    QStringList terms = tokenize(query);
+    terms.removeDuplicates();
+    if (terms.isEmpty() || limit <= 0) {
+        return {};
+    }
+
+    // The last term may still be being typed, so it is left open.
+    QVector<quint64> grams;
+    for (qsizetype i = 0; i < terms.size(); ++i) {
+        appendTrigrams(terms.at(i), i + 1 < terms.size(), &grams);
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    if (grams.isEmpty()) {
+        return {};
+    }
+
+    QVector<quint16> hits(m_ids.size(), 0);
+    QVector<int> touched;
+    for (const quint64 gram : std::as_const(grams)) {
+        const auto posting = m_trigrams.constFind(gram);
+        if (posting == m_trigrams.constEnd()) {
+            continue;
+        }
+        for (const int doc : posting.value()) {
+            if (hits[doc]++ == 0) {
+                touched.append(doc);
+            }
+        }
+    }
+
+    const int minShared = std::max<int>(1, (grams.size() + 2) / 3);
+    QVector<QPair<int, int>> candidates;
+    for (const int doc : std::as_const(touched)) {
+        if (hits.at(doc) >= minShared) {
+            candidates.append({doc, hits.at(doc)});
+        }
+    }
+    if (candidates.size() > kMaxFuzzyCandidates) {
+        std::nth_element(candidates.begin(), candidates.begin() + kMaxFuzzyCandidates, candidates.end(),
+                         [](const QPair<int, int> &left, const QPair<int, int> &right) {
+                             return left.second > right.second;
+                         });
+        candidates.resize(kMaxFuzzyCandidates);
+    }
+
+    // Candidates share most of their tokens, so each term's distance to a
+    // token is computed once per query.
+    QVector<QHash<QString, int>> distances(terms.size());
+    QVector<Match> matches;
+    for (const QPair<int, int> &candidate : std::as_const(candidates)) {
+        const int score = titleScore(terms, candidate.first, &distances);
+        if (score >= 0) {
+            matches.append({m_ids.at(candidate.first), score + candidate.second});
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [](const Match &left, const Match &right) {
+        return left.score != right.score ? left.score > right.score : left.id < right.id;
+    });
+    if (matches.size() > limit) {
+        matches.resize(limit);
+    }
+    return matches;
+}
+
+int SearchIndex::size() const {
+    return m_docById.size();
+}
+
+QVector<int> SearchIndex::docsForTerm(const QString &term) const {
+    QVector<int> docs;
+    int lists = 0;
+    if (term.size() <= kMaxInfixTermLength) {
+        for (auto it = m_postings.cbegin(); it != m_postings.cend(); ++it) {
+            if (it.key().contains(term)) {
+                docs += it.value();
+                ++lists;
+            }
+        }
+    } else {
+        for (auto it = m_postings.lowerBound(term); it != m_postings.cend() && it.key().startsWith(term); ++it) {
+            docs += it.value();
+            ++lists;
+        }
+    }
+    if (lists > 1) {
+        std::sort(docs.begin(), docs.end());
+        docs.erase(std::unique(docs.begin(), docs.end()), docs.end());
+    }
+    return docs;
+}
+
+// Best score over the item's titles, or -1 when some term has no token
+// within its edit bound in any of them.
+int SearchIndex::titleScore(const QStringList &terms, int doc, QVector<QHash<QString, int>> *distances) const {
+    const QVector<QStringList> &titles = m_docTitles.at(doc);
+    int best = -1;
+    for (qsizetype t = 0; t < titles.size(); ++t) {
+        const QStringList &tokens = titles.at(t);
+        if (tokens.isEmpty()) {
+            continue;
+        }
+        int edits = 0;
+        bool matched = true;
+        for (qsizetype i = 0; i < terms.size(); ++i) {
+            const QString &term = terms.at(i);
+            QHash<QString, int> &known = (*distances)[i];
+            const int bound = maxEditsFor(term);
+            int distance = bound + 1;
+            for (const QString &token : tokens) {
+                auto it = known.constFind(token);
+                if (it == known.constEnd()) {
+                    it = known.insert(token, termDistance(term, token, bound));
+                }
+                distance = std::min(distance, it.value());
+                if (distance == 0) {
+                    break;
+                }
+            }
+            if (distance > bound) {
+                matched = false;
+                break;
+            }
+            edits += distance;
+        }
+        if (!matched) {
+            continue;
+        }
+        int score = 100 * int(terms.size()) - 40 * edits - int(tokens.size());
+        if (t == 0) {
+            score += 5;
+        }
+        if (tokens.first().startsWith(terms.first())) {
+            score += 20;
+        }
+        best = std::max(best, std::max(score, 0));
+    }
+    return best;
+}
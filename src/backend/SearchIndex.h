@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "backend/MediaItem.h"
+
+// Inverted index over item titles, overviews and genres. Text is case folded
+// and stripped of diacritics; each query term matches any indexed token it is
+// a prefix of, and an item matches when every term does. Short terms also
+// match inside tokens, as the old substring filter did, so "man" still finds
+// "Batman"; longer terms only match token prefixes.
+//
+// Titles, including alternate titles, are also indexed by trigram for
+// typo-tolerant ranked search: trigram overlap picks candidates and a bounded
+// edit distance per term scores them.
+//
+// Queries only read, so a copy of the index can be searched on another
+// thread while the original keeps being updated.
+class SearchIndex {
+public:
+    struct Match {
+        QString id;
+        int score = 0;
+    };
+
+    static QString fold(const QString &text);
+    static QStringList tokenize(const QString &text);
+
+    void clear();
+    // Replaces whatever was indexed for the item's id.
+    void insert(const MediaItem &item);
+    void remove(const QString &id);
+
+    QStringList search(const QString &query) const;
+    // Best title matches first, at most limit of them.
+    QVector<Match> rankedSearch(const QString &query, int limit) const;
+    int size() const;
+
+private:
+    QVector<int> docsForTerm(const QString &term) const;
+    int titleScore(const QStringList &terms, int doc, QVector<QHash<QString, int>> *distances) const;
+
+    QMap<QString, QVector<int>> m_postings;
+    QHash<QString, int> m_docById;
+    QVector<QString> m_ids;
+    QVector<QStringList> m_docTokens;
+    QHash<quint64, QVector<int>> m_trigrams;
+    QVector<QVector<QStringList>> m_docTitles;
+    QVector<int> m_freeDocs;
+};
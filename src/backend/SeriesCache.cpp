@@ -0,0 +1,136 @@
+#include "backend/SeriesCache.h"
+
+#include "backend/JsonBackend.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+constexpr quint32 kSeriesCacheMagic = 0x454c5853;
+constexpr quint16 kSeriesCacheVersion = 1;
+} // namespace
+
+SeriesCache::SeriesCache(int maxEntries, qint64 ttlMs)
+    : m_entries(maxEntries),
+      m_ttlMs(ttlMs) {
+    m_diskPool.setMaxThreadCount(1);
+}
+
+QString SeriesCache::directory() const {
+    return m_directory;
+}
+
+void SeriesCache::setDirectory(const QString &path) {
+    m_directory = path;
+    if (m_directory.isEmpty()) {
+        return;
+    }
+    QDir dir(m_directory);
+    dir.mkpath(".");
+    const QDateTime cutoff = QDateTime::currentDateTimeUtc().addMSecs(-m_ttlMs);
+    const QFileInfoList files = dir.entryInfoList({"*.series"}, QDir::Files);
+    for (const QFileInfo &info : files) {
+        if (info.lastModified() < cutoff) {
+            QFile::remove(info.absoluteFilePath());
+        }
+    }
+}
+
+void SeriesCache::setScope(const QString &scope) {
+    if (m_scope == scope) {
+        return;
+    }
+    m_scope = scope;
+    m_entries.clear();
+}
+
+bool SeriesCache::lookup(const QString &key, QJsonDocument *doc) {
+    if (const Entry *entry = m_entries.object(key)) {
+        if (isFresh(entry->storedAt)) {
+            *doc = entry->doc;
+            return true;
+        }
+        m_entries.remove(key);
+    }
+    if (m_directory.isEmpty()) {
+        return false;
+    }
+
+    const QString path = filePathForKey(key);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 storedAt = 0;
+    in >> magic >> version >> storedAt;
+    if (in.status() != QDataStream::Ok || magic != kSeriesCacheMagic || version != kSeriesCacheVersion
+        || !isFresh(storedAt)) {
+        file.close();
+        QFile::remove(path);
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument parsed = JsonBackend::parse(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        file.close();
+        QFile::remove(path);
+        return false;
+    }
+    m_entries.insert(key, new Entry{parsed, storedAt});
+    *doc = parsed;
+    return true;
+}
+
+void SeriesCache::insert(const QString &key, const QJsonDocument &doc) {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    m_entries.insert(key, new Entry{doc, now});
+    if (m_directory.isEmpty()) {
+        return;
+    }
+    QtConcurrent::run(&m_diskPool, [path = filePathForKey(key), doc, now]() {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return;
+        }
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_6_5);
+        out << kSeriesCacheMagic << kSeriesCacheVersion << now;
+        file.write(doc.toJson(QJsonDocument::Compact));
+        file.commit();
+    });
+}
+
+void SeriesCache::clear() {
+    m_entries.clear();
+    if (m_directory.isEmpty()) {
+        return;
+    }
+    // Queued behind pending writes so none of them lands after the clear.
+    QtConcurrent::run(&m_diskPool, [directory = m_directory]() {
+        QDir dir(directory);
+        const QStringList files = dir.entryList({"*.series"}, QDir::Files);
+        for (const QString &name : files) {
+            dir.remove(name);
+        }
+    });
+}
+
+QString SeriesCache::filePathForKey(const QString &key) const {
+    const QByteArray hash = QCryptographicHash::hash((m_scope + '\n' + key).toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QDir(m_directory).filePath(QString::fromLatin1(hash) + ".series");
+}
+
+bool SeriesCache::isFresh(qint64 storedAt) const {
+    const qint64 age = QDateTime::currentMSecsSinceEpoch() - storedAt;
+    return age >= 0 && age <= m_ttlMs;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QCache>
+#include <QJsonDocument>
+#include <QString>
+#include <QThreadPool>
+
+// Short-lived cache for the series -> seasons -> episodes hierarchy. Entries
+// expire after a TTL; the memory tier is LRU-bounded and, when a directory is
+// set, a disk tier keeps entries across restarts. Disk writes and removals
+// run in order on a background thread.
+class SeriesCache {
+public:
+    explicit SeriesCache(int maxEntries = 128, qint64 ttlMs = 10 * 60 * 1000);
+
+    QString directory() const;
+    void setDirectory(const QString &path);
+
+    // Entries are kept per server and account, since episodes and seasons
+    // carry the account's progress; switching scope drops the memory tier.
+    void setScope(const QString &scope);
+
+    bool lookup(const QString &key, QJsonDocument *doc);
+    void insert(const QString &key, const QJsonDocument &doc);
+    void clear();
+
+private:
+    struct Entry {
+        QJsonDocument doc;
+        qint64 storedAt = 0;
+    };
+
+    QString filePathForKey(const QString &key) const;
+    bool isFresh(qint64 storedAt) const;
+
+    QCache<QString, Entry> m_entries;
+    QThreadPool m_diskPool;
+    qint64 m_ttlMs = 0;
+    QString m_directory;
+    QString m_scope;
+};
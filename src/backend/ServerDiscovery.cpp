@@ -1,5 +1,7 @@
 #include "backend/ServerDiscovery.h"
 
+#include "backend/HttpCore.h"
+
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -7,6 +9,7 @@
 #include <QNetworkReply>
 #include <QTimer>
 #include <QUrl>
+#include <QtConcurrent/QtConcurrentRun>
 
 #ifdef ELIXIR_HAS_DNSSD
 #include <QSocketNotifier>
@@ -20,10 +23,62 @@
 namespace {
 constexpr int kProbeTimeoutMs = 1500;
 constexpr const char *kServiceType = "_elixir-media._tcp";
+
+struct RegistryResult {
+    QVector<ServerEntry> entries;
+    QString error;
+};
+
+RegistryResult parseRegistryEntries(const QByteArray &payload) {
+    RegistryResult result;
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(payload, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        result.error = QString("Registry JSON error: %1").arg(parseError.errorString());
+        return result;
+    }
+
+    if (!doc.isArray()) {
+        result.error = "Registry response was not a list.";
+        return result;
+    }
+
+    QVector<ServerEntry> &entries = result.entries;
+    const QJsonArray array = doc.array();
+    entries.reserve(array.size());
+    for (const QJsonValue &value : array) {
+        if (!value.isObject()) {
+            continue;
+        }
+        const QJsonObject obj = value.toObject();
+        ServerEntry entry;
+        entry.serverId = obj.value("server_id").toString();
+        entry.name = obj.value("device_name").toString();
+        entry.status = obj.value("status").toString();
+        entry.lastSeenAt = obj.value("last_seen_at").toString();
+        entry.wanEndpoint = obj.value("wan_direct_endpoint").toString();
+        entry.overlayEndpoint = obj.value("overlay_endpoint").toString();
+        entry.source = "registry";
+        entry.key = QString("registry:%1").arg(entry.serverId.isEmpty() ? entry.name : entry.serverId);
+
+        const QJsonValue lanValue = obj.value("lan_addresses");
+        if (lanValue.isArray()) {
+            const QJsonArray lanArray = lanValue.toArray();
+            for (const QJsonValue &lanEntry : lanArray) {
+                entry.lanAddresses.append(lanEntry.toString());
+            }
+        }
+
+        entries.push_back(entry);
+    }
+
+    return result;
+}
 } // namespace
 
-ServerDiscovery::ServerDiscovery(QObject *parent)
-    : QObject(parent) {
+ServerDiscovery::ServerDiscovery(HttpCore *http, QObject *parent)
+    : QObject(parent),
+      m_http(http) {
     m_mdnsModel.setPreferredNetworkType(m_preferredNetworkType);
     m_registryModel.setPreferredNetworkType(m_preferredNetworkType);
 }
@@ -47,7 +102,7 @@ QString ServerDiscovery::registryBaseUrl() const {
 }
 
 void ServerDiscovery::setRegistryBaseUrl(const QString &value) {
-    const QString normalized = normalizeEndpoint(value);
+    const QString normalized = HttpCore::normalizeBaseUrl(value);
     if (m_registryBaseUrl == normalized) {
         return;
     }
@@ -106,77 +161,31 @@ void ServerDiscovery::refreshRegistry() {
         return;
     }
 
-    QUrl base(m_registryBaseUrl);
-    QUrl url = base.resolved(QUrl("/api/v1/me/servers"));
-
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    if (!m_authToken.isEmpty()) {
-        request.setRawHeader("Authorization", QByteArray("Bearer ") + m_authToken.toUtf8());
-    }
-
-    QNetworkReply *reply = m_manager.get(request);
+    const QUrl url = HttpCore::makeUrl(m_registryBaseUrl, "/api/v1/me/servers");
+    QNetworkReply *reply = m_http->send("GET", HttpCore::makeRequest(url, m_authToken), QByteArray(), "registry");
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
         const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
         const QByteArray payload = reply->readAll();
         const bool okStatus = status >= 200 && status < 300;
 
         if (reply->error() != QNetworkReply::NoError || !okStatus) {
-            const QString detail = payload.isEmpty()
-                ? reply->errorString()
-                : QString::fromUtf8(payload);
+            const QString detail = HttpCore::errorDetail(reply, payload);
             setStatusMessage(QString("Registry fetch failed: %1").arg(detail));
             reply->deleteLater();
             return;
         }
 
-        QJsonParseError parseError;
-        const QJsonDocument doc = QJsonDocument::fromJson(payload, &parseError);
-        if (parseError.error != QJsonParseError::NoError) {
-            setStatusMessage(QString("Registry JSON error: %1").arg(parseError.errorString()));
-            reply->deleteLater();
-            return;
-        }
-
-        if (!doc.isArray()) {
-            setStatusMessage("Registry response was not a list.");
-            reply->deleteLater();
-            return;
-        }
-
-        QVector<ServerEntry> entries;
-        const QJsonArray array = doc.array();
-        entries.reserve(array.size());
-        for (const QJsonValue &value : array) {
-            if (!value.isObject()) {
-                continue;
-            }
-            const QJsonObject obj = value.toObject();
-            ServerEntry entry;
-            entry.serverId = obj.value("server_id").toString();
-            entry.name = obj.value("device_name").toString();
-            entry.status = obj.value("status").toString();
-            entry.lastSeenAt = obj.value("last_seen_at").toString();
-            entry.wanEndpoint = obj.value("wan_direct_endpoint").toString();
-            entry.overlayEndpoint = obj.value("overlay_endpoint").toString();
-            entry.source = "registry";
-            entry.key = QString("registry:%1").arg(entry.serverId.isEmpty() ? entry.name : entry.serverId);
-
-            const QJsonValue lanValue = obj.value("lan_addresses");
-            if (lanValue.isArray()) {
-                const QJsonArray lanArray = lanValue.toArray();
-                for (const QJsonValue &lanEntry : lanArray) {
-                    entry.lanAddresses.append(lanEntry.toString());
-                }
-            }
-
-            entries.push_back(entry);
-        }
-
-        m_registryModel.setEntries(entries);
-        setStatusMessage(QString("Found %1 registry server(s).").arg(entries.size()));
-        probeAll();
         reply->deleteLater();
+        QtConcurrent::run(&parseRegistryEntries, payload)
+            .then(this, [this](const RegistryResult &result) {
+                if (!result.error.isEmpty()) {
+                    setStatusMessage(result.error);
+                    return;
+                }
+                m_registryModel.setEntries(result.entries);
+                setStatusMessage(QString("Found %1 registry server(s).").arg(result.entries.size()));
+                probeAll();
+            });
     });
 }
 
@@ -200,20 +209,6 @@ void ServerDiscovery::setStatusMessage(const QString &value) {
     emit statusMessageChanged();
 }
 
-QString ServerDiscovery::normalizeEndpoint(const QString &value) const {
-    QString trimmed = value.trimmed();
-    if (trimmed.isEmpty()) {
-        return trimmed;
-    }
-    if (!trimmed.startsWith("http://") && !trimmed.startsWith("https://")) {
-        trimmed.prepend("http://");
-    }
-    while (trimmed.endsWith('/')) {
-        trimmed.chop(1);
-    }
-    return trimmed;
-}
-
 void ServerDiscovery::probeEntry(const ServerEntry &entry) {
     if (!entry.lanAddresses.isEmpty()) {
         probeEndpoint(entry.key, "lan", entry.lanAddresses.first());
@@ -224,7 +219,7 @@ void ServerDiscovery::probeEntry(const ServerEntry &entry) {
 }
 
 void ServerDiscovery::probeEndpoint(const QString &entryKey, const QString &endpointType, const QString &endpoint) {
-    const QString normalized = normalizeEndpoint(endpoint);
+    const QString normalized = HttpCore::normalizeBaseUrl(endpoint);
     if (normalized.isEmpty()) {
         return;
     }
@@ -235,7 +230,7 @@ void ServerDiscovery::probeEndpoint(const QString &entryKey, const QString &endp
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::UserAgentHeader, "ElixirClient/1.0");
 
-    QNetworkReply *reply = m_manager.get(request);
+    QNetworkReply *reply = m_http->send("GET", request, QByteArray(), endpointType);
     QTimer *timer = new QTimer(reply);
     timer->setSingleShot(true);
 
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <QObject>
-#include <QNetworkAccessManager>
 #include <QHash>
 
 #include "backend/ServerListModel.h"
@@ -10,6 +9,7 @@
 #include <dns_sd.h>
 #endif
 
+class HttpCore;
 class QNetworkReply;
 class QTimer;
 class QSocketNotifier;
@@ -25,7 +25,7 @@ class ServerDiscovery : public QObject {
     Q_PROPERTY(bool browsing READ browsing NOTIFY browsingChanged)
 
 public:
-    explicit ServerDiscovery(QObject *parent = nullptr);
+    explicit ServerDiscovery(HttpCore *http, QObject *parent = nullptr);
     ~ServerDiscovery() override;
 
     ServerListModel *mdnsModel();
@@ -64,14 +64,13 @@ private:
     };
 
     void setStatusMessage(const QString &value);
-    QString normalizeEndpoint(const QString &value) const;
     void probeEntry(const ServerEntry &entry);
     void probeEndpoint(const QString &entryKey, const QString &endpointType, const QString &endpoint);
     void handleProbeFinished(QNetworkReply *reply, bool forcedFailure);
 
     ServerListModel m_mdnsModel;
     ServerListModel m_registryModel;
-    QNetworkAccessManager m_manager;
+    HttpCore *m_http = nullptr;
     QString m_registryBaseUrl;
     QString m_authToken;
     QString m_preferredNetworkType = "auto";
@@ -131,6 +131,8 @@ QVariantMap ServerListModel::get(int index) const {
 void ServerListModel::setEntries(const QVector<ServerEntry> &entries) {
     beginResetModel();
     m_entries = entries;
+    m_rowByKey.clear();
+    reindexFrom(0);
     endResetModel();
     emit countChanged();
 }
@@ -146,6 +148,7 @@ void ServerListModel::upsertEntry(const ServerEntry &entry) {
     const int row = m_entries.size();
     beginInsertRows(QModelIndex(), row, row);
     m_entries.push_back(entry);
+    m_rowByKey.insert(entry.key, row);
     endInsertRows();
     emit countChanged();
 }
@@ -157,6 +160,8 @@ void ServerListModel::removeEntry(const QString &key) {
     }
     beginRemoveRows(QModelIndex(), index, index);
     m_entries.removeAt(index);
+    m_rowByKey.remove(key);
+    reindexFrom(index);
     endRemoveRows();
     emit countChanged();
 }
@@ -167,6 +172,7 @@ void ServerListModel::clear() {
     }
     beginResetModel();
     m_entries.clear();
+    m_rowByKey.clear();
     endResetModel();
     emit countChanged();
 }
@@ -195,12 +201,13 @@ QVector<ServerEntry> ServerListModel::entries() const {
 }
 
 int ServerListModel::indexForKey(const QString &key) const {
-    for (int i = 0; i < m_entries.size(); ++i) {
-        if (m_entries.at(i).key == key) {
-            return i;
-        }
+    return m_rowByKey.value(key, -1);
+}
+
+void ServerListModel::reindexFrom(int row) {
+    for (int i = row; i < m_entries.size(); ++i) {
+        m_rowByKey.insert(m_entries.at(i).key, i);
     }
-    return -1;
 }
 
 QString ServerListModel::primaryLanAddress(const ServerEntry &entry) const {
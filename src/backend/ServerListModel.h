@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QStringList>
 #include <QVariant>
 #include <QVector>
@@ -79,9 +80,11 @@ private:
     };
 
     int indexForKey(const QString &key) const;
+    void reindexFrom(int row);
     QString primaryLanAddress(const ServerEntry &entry) const;
     Selection selectEndpoint(const ServerEntry &entry) const;
 
     QVector<ServerEntry> m_entries;
+    QHash<QString, int> m_rowByKey;
     QString m_preferredNetworkType = "auto";
 };
@@ -19,6 +19,7 @@ constexpr const char *kSubtitleLangKey = "playback/subtitleLang";
 constexpr const char *kSubtitleTitleKey = "playback/subtitleTitle";
 constexpr const char *kEmailKey = "session/email";
 constexpr const char *kNetworkTypeKey = "session/networkType";
+constexpr const char *kCleartextHttp2Key = "network/cleartextHttp2";
 }
 
 SessionManager::SessionManager(QObject *parent)
@@ -40,7 +41,8 @@ SessionManager::SessionManager(QObject *parent)
       m_subtitleLang(m_settings.value(kSubtitleLangKey, "").toString()),
       m_subtitleTitle(m_settings.value(kSubtitleTitleKey, "").toString()),
       m_email(m_settings.value(kEmailKey, "").toString()),
-      m_networkType(m_settings.value(kNetworkTypeKey, "auto").toString()) {}
+      m_networkType(m_settings.value(kNetworkTypeKey, "auto").toString()),
+      m_cleartextHttp2(m_settings.value(kCleartextHttp2Key, false).toBool()) {}
 
 QString SessionManager::baseUrl() const {
     return m_baseUrl;
@@ -276,6 +278,19 @@ void SessionManager::setNetworkType(const QString &value) {
     emit networkTypeChanged();
 }
 
+bool SessionManager::cleartextHttp2() const {
+    return m_cleartextHttp2;
+}
+
+void SessionManager::setCleartextHttp2(bool value) {
+    if (m_cleartextHttp2 == value) {
+        return;
+    }
+    m_cleartextHttp2 = value;
+    storeValue(kCleartextHttp2Key, m_cleartextHttp2);
+    emit cleartextHttp2Changed();
+}
+
 void SessionManager::clearAuth() {
     setAuthToken(QString());
     setAccessTokenExpiresAt(QString());
@@ -23,6 +23,7 @@ class SessionManager : public QObject {
     Q_PROPERTY(QString subtitleTitle READ subtitleTitle WRITE setSubtitleTitle NOTIFY subtitleTitleChanged)
     Q_PROPERTY(QString email READ email WRITE setEmail NOTIFY emailChanged)
     Q_PROPERTY(QString networkType READ networkType WRITE setNetworkType NOTIFY networkTypeChanged)
+    Q_PROPERTY(bool cleartextHttp2 READ cleartextHttp2 WRITE setCleartextHttp2 NOTIFY cleartextHttp2Changed)
 
 public:
     explicit SessionManager(QObject *parent = nullptr);
@@ -81,6 +82,9 @@ public:
     QString networkType() const;
     void setNetworkType(const QString &value);
 
+    bool cleartextHttp2() const;
+    void setCleartextHttp2(bool value);
+
     Q_INVOKABLE void clearAuth();
     Q_INVOKABLE void clearControlPlaneAuth();
 
@@ -103,6 +107,7 @@ signals:
     void subtitleTitleChanged();
     void emailChanged();
     void networkTypeChanged();
+    void cleartextHttp2Changed();
 
 private:
     void storeValue(const QString &key, const QVariant &value);
@@ -126,4 +131,5 @@ private:
     QString m_subtitleTitle;
     QString m_email;
     QString m_networkType;
+    bool m_cleartextHttp2 = false;
 };
@@ -0,0 +1,206 @@
+#include "backend/TraceRecorder.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace {
+constexpr int kMaxEvents = 500000;
+
+QElapsedTimer &traceClock() {
+    static QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock;
+}
+
+std::atomic<int> g_nextThreadId{1};
+} // namespace
+
+std::atomic<bool> TraceRecorder::s_enabled{false};
+
+TraceRecorder::TraceRecorder(QObject *parent)
+    : QObject(parent) {
+    traceClock();
+    if (!qEnvironmentVariableIsEmpty("ELIXIR_TRACE")) {
+        s_enabled.store(true, std::memory_order_relaxed);
+    }
+}
+
+TraceRecorder *TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return &recorder;
+}
+
+qint64 TraceRecorder::now() {
+    return traceClock().nsecsElapsed() / 1000;
+}
+
+int TraceRecorder::currentThreadId() {
+    thread_local int threadId = 0;
+    if (threadId == 0) {
+        threadId = g_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+        QThread *thread = QThread::currentThread();
+        QString name = thread ? thread->objectName() : QString();
+        if (name.isEmpty() && QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+            name = QStringLiteral("main");
+        } else if (name.isEmpty()) {
+            name = QString("thread %1").arg(threadId);
+        }
+        TraceRecorder *recorder = instance();
+        QMutexLocker locker(&recorder->m_mutex);
+        recorder->m_threadNames.append({threadId, name});
+    }
+    return threadId;
+}
+
+void TraceRecorder::record(Event event) {
+    event.threadId = currentThreadId();
+    TraceRecorder *recorder = instance();
+    QMutexLocker locker(&recorder->m_mutex);
+    if (recorder->m_events.size() < kMaxEvents) {
+        recorder->m_events.append(std::move(event));
+    }
+}
+
+void TraceRecorder::complete(const char *name, const char *category, qint64 startUs, qint64 endUs) {
+    if (!isEnabled()) {
+        return;
+    }
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.phase = 'X';
+    event.timestampUs = startUs;
+    event.durationUs = endUs - startUs;
+    record(std::move(event));
+}
+
+void TraceRecorder::asyncBegin(const char *name, const char *category, quint64 id, const QString &detail) {
+    if (!isEnabled()) {
+        return;
+    }
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.detail = detail;
+    event.phase = 'b';
+    event.timestampUs = now();
+    event.id = id;
+    record(std::move(event));
+}
+
+void TraceRecorder::asyncEnd(const char *name, const char *category, quint64 id) {
+    if (!isEnabled()) {
+        return;
+    }
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.phase = 'e';
+    event.timestampUs = now();
+    event.id = id;
+    record(std::move(event));
+}
+
+bool TraceRecorder::enabled() const {
+    return isEnabled();
+}
+
+void TraceRecorder::setEnabled(bool value) {
+    if (isEnabled() == value) {
+        return;
+    }
+    s_enabled.store(value, std::memory_order_relaxed);
+    emit enabledChanged();
+}
+
+QString TraceRecorder::lastTracePath() const {
+    return m_lastTracePath;
+}
+
+void TraceRecorder::instant(const QString &name, const QString &category) {
+    if (!isEnabled()) {
+        return;
+    }
+    Event event;
+    event.name = name.toUtf8();
+    event.category = category.toUtf8();
+    event.phase = 'i';
+    event.timestampUs = now();
+    record(std::move(event));
+}
+
+QString TraceRecorder::write() {
+    QVector<Event> events;
+    QVector<QPair<int, QString>> threadNames;
+    {
+        QMutexLocker locker(&m_mutex);
+        events.swap(m_events);
+        threadNames = m_threadNames;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    for (const auto &thread : threadNames) {
+        traceEvents.append(QJsonObject{
+            {"name", "thread_name"},
+            {"ph", "M"},
+            {"pid", pid},
+            {"tid", thread.first},
+            {"args", QJsonObject{{"name", thread.second}}},
+        });
+    }
+    for (const Event &event : events) {
+        QJsonObject object{
+            {"name", QString::fromUtf8(event.name)},
+            {"cat", QString::fromUtf8(event.category)},
+            {"ph", QString(QChar(event.phase))},
+            {"ts", event.timestampUs},
+            {"pid", pid},
+            {"tid", event.threadId},
+        };
+        if (event.phase == 'X') {
+            object.insert("dur", event.durationUs);
+        } else if (event.phase == 'i') {
+            object.insert("s", "t");
+        } else {
+            object.insert("id", QString("0x%1").arg(event.id, 0, 16));
+        }
+        if (!event.detail.isEmpty()) {
+            object.insert("args", QJsonObject{{"detail", event.detail}});
+        }
+        traceEvents.append(object);
+    }
+
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/traces";
+    if (!QDir().mkpath(dir)) {
+        return QString();
+    }
+    const QString path = QDir(dir).filePath(
+        QString("trace-%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss")));
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+    file.write(QJsonDocument(QJsonObject{
+        {"traceEvents", traceEvents},
+        {"displayTimeUnit", "ms"},
+    }).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        return QString();
+    }
+    m_lastTracePath = path;
+    emit lastTracePathChanged();
+    return path;
+}
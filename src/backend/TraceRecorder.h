@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+// Records Chrome trace-event JSON (loadable in Perfetto / chrome://tracing).
+// Recording is off unless ELIXIR_TRACE is set or it is enabled from QML.
+class TraceRecorder : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(QString lastTracePath READ lastTracePath NOTIFY lastTracePathChanged)
+
+public:
+    static TraceRecorder *instance();
+
+    static bool isEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    static qint64 now();
+    static void complete(const char *name, const char *category, qint64 startUs, qint64 endUs);
+    static void asyncBegin(const char *name, const char *category, quint64 id, const QString &detail = QString());
+    static void asyncEnd(const char *name, const char *category, quint64 id);
+
+    bool enabled() const;
+    void setEnabled(bool value);
+
+    QString lastTracePath() const;
+
+    Q_INVOKABLE void instant(const QString &name, const QString &category = QStringLiteral("qml"));
+    Q_INVOKABLE QString write();
+
+signals:
+    void enabledChanged();
+    void lastTracePathChanged();
+
+private:
+    struct Event {
+        QByteArray name;
+        QByteArray category;
+        QString detail;
+        char phase = 'X';
+        qint64 timestampUs = 0;
+        qint64 durationUs = 0;
+        quint64 id = 0;
+        int threadId = 0;
+    };
+
+    explicit TraceRecorder(QObject *parent = nullptr);
+
+    static void record(Event event);
+    static int currentThreadId();
+
+    static std::atomic<bool> s_enabled;
+    QMutex m_mutex;
+    QVector<Event> m_events;
+    QVector<QPair<int, QString>> m_threadNames;
+    QString m_lastTracePath;
+};
+
+class TraceSpan {
+public:
+    TraceSpan(const char *name, const char *category)
+        : m_name(name),
+          m_category(category),
+          m_startUs(TraceRecorder::isEnabled() ? TraceRecorder::now() : -1) {}
+
+    ~TraceSpan() {
+        if (m_startUs >= 0) {
+            TraceRecorder::complete(m_name, m_category, m_startUs, TraceRecorder::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *m_name;
+    const char *m_category;
+    qint64 m_startUs;
+};
@@ -7,74 +7,41 @@
 #include <QSGRendererInterface>
 #include <QUrl>
 #include <QDateTime>
-#include <QFile>
 #include <QDir>
-#include <QMutex>
-#include <QMutexLocker>
+#include <QLoggingCategory>
 #include <QStandardPaths>
-#include <QTextStream>
 
 #include "backend/ApiClient.h"
+#include "backend/AsyncLogger.h"
 #include "backend/ControlPlaneClient.h"
+#include "backend/HttpCore.h"
 #include "backend/LibraryModel.h"
+#include "backend/Logging.h"
 #include "backend/MpvItem.h"
 #include "backend/PlayerController.h"
+#include "backend/PrefetchService.h"
 #include "backend/ServerDiscovery.h"
 #include "backend/SessionManager.h"
+#include "backend/TraceRecorder.h"
 
 namespace {
-QFile *g_logFile = nullptr;
-QMutex g_logMutex;
-
-QString logLevelName(QtMsgType type) {
-    switch (type) {
-        case QtDebugMsg:
-            return "DEBUG";
-        case QtInfoMsg:
-            return "INFO";
-        case QtWarningMsg:
-            return "WARN";
-        case QtCriticalMsg:
-            return "CRITICAL";
-        case QtFatalMsg:
-            return "FATAL";
-    }
-    return "LOG";
-}
-
-void logMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
-    const QString timestamp = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
-    const QString level = logLevelName(type);
-    const QString category = QString::fromUtf8(context.category ? context.category : "");
-    QString line = QString("%1 [%2] %3: %4").arg(timestamp, level, category, msg);
-    if (context.file && context.line > 0) {
-        line.append(QString(" (%1:%2)").arg(context.file).arg(context.line));
-    }
-
-    {
-        QMutexLocker locker(&g_logMutex);
-        if (g_logFile && g_logFile->isOpen()) {
-            QTextStream out(g_logFile);
-            out << line << '\n';
-            out.flush();
-        }
-    }
-    fprintf(stderr, "%s\n", line.toUtf8().constData());
-    if (type == QtFatalMsg) {
-        abort();
+void initLogging() {
+    // Debug output is off unless enabled, e.g. ELIXIR_LOG_RULES="elixir.api.debug=true".
+    QString rules = "elixir.*.debug=false";
+    const QString extraRules = qEnvironmentVariable("ELIXIR_LOG_RULES");
+    if (!extraRules.isEmpty()) {
+        rules += '\n' + QString(extraRules).replace(';', '\n');
     }
-}
+    QLoggingCategory::setFilterRules(rules);
 
-void initLogging() {
+    QString logPath;
     const QString logDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
     if (!logDir.isEmpty()) {
         QDir().mkpath(logDir);
-        const QString logPath = logDir + "/client.log";
-        g_logFile = new QFile(logPath);
-        g_logFile->open(QIODevice::Append | QIODevice::Text);
+        logPath = logDir + "/client.log";
     }
-    qInstallMessageHandler(logMessageHandler);
-    qInfo() << "Elixir client logging to" << (g_logFile ? g_logFile->fileName() : "stderr");
+    AsyncLogger::install(logPath);
+    qCInfo(lcApp) << "Elixir client logging to" << (logPath.isEmpty() ? QString("stderr") : logPath);
 }
 } // namespace
 
@@ -88,14 +55,18 @@ int main(int argc, char *argv[]) {
 
     QQuickStyle::setStyle("Fusion");
     initLogging();
-    qInfo() << "Elixir client starting" << QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    // ELIXIR_TRACE=1 records from startup; the trace is written on exit.
+    TraceRecorder::instance();
+    qCInfo(lcApp) << "Elixir client starting" << QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
 
     SessionManager sessionManager;
-    ApiClient apiClient;
-    ControlPlaneClient controlPlaneClient;
+    HttpCore httpCore;
+    ApiClient apiClient(&httpCore);
+    ControlPlaneClient controlPlaneClient(&httpCore);
     LibraryModel libraryModel;
     PlayerController playerController;
-    ServerDiscovery serverDiscovery;
+    PrefetchService prefetchService(&apiClient);
+    ServerDiscovery serverDiscovery(&httpCore);
 
     const QString expiry = sessionManager.accessTokenExpiresAt();
     if (!sessionManager.authToken().isEmpty() && !expiry.isEmpty()) {
@@ -119,7 +90,12 @@ int main(int argc, char *argv[]) {
     apiClient.setAuthToken(sessionManager.authToken());
     apiClient.setAccessTokenExpiresAt(sessionManager.accessTokenExpiresAt());
     apiClient.setNetworkType(sessionManager.networkType());
+    httpCore.setCleartextHttp2Allowed(sessionManager.cleartextHttp2());
     libraryModel.setBaseUrl(sessionManager.baseUrl());
+    libraryModel.setAccountId(apiClient.accountId());
+    if (!sessionManager.authToken().isEmpty() && libraryModel.loadSnapshot()) {
+        qCInfo(lcApp) << "Library snapshot loaded" << libraryModel.count() << "items";
+    }
     controlPlaneClient.setBaseUrl(sessionManager.registryUrl());
     controlPlaneClient.setAuthToken(sessionManager.controlPlaneToken());
     controlPlaneClient.setAccessTokenExpiresAt(sessionManager.controlPlaneExpiresAt());
@@ -153,6 +129,9 @@ int main(int argc, char *argv[]) {
     QObject::connect(&sessionManager, &SessionManager::networkTypeChanged, &apiClient, [&]() {
         apiClient.setNetworkType(sessionManager.networkType());
     });
+    QObject::connect(&sessionManager, &SessionManager::cleartextHttp2Changed, &httpCore, [&]() {
+        httpCore.setCleartextHttp2Allowed(sessionManager.cleartextHttp2());
+    });
     QObject::connect(&sessionManager, &SessionManager::registryUrlChanged, &serverDiscovery, [&]() {
         serverDiscovery.setRegistryBaseUrl(sessionManager.registryUrl());
     });
@@ -180,6 +159,9 @@ int main(int argc, char *argv[]) {
     QObject::connect(&apiClient, &ApiClient::authTokenChanged, &sessionManager, [&]() {
         sessionManager.setAuthToken(apiClient.authToken());
     });
+    QObject::connect(&apiClient, &ApiClient::accountIdChanged, &libraryModel, [&]() {
+        libraryModel.setAccountId(apiClient.accountId());
+    });
     QObject::connect(&apiClient, &ApiClient::accessTokenExpiresAtChanged, &sessionManager, [&]() {
         sessionManager.setAccessTokenExpiresAt(apiClient.accessTokenExpiresAt());
     });
@@ -190,7 +172,12 @@ int main(int argc, char *argv[]) {
         sessionManager.setControlPlaneExpiresAt(controlPlaneClient.accessTokenExpiresAt());
     });
 
-    QObject::connect(&apiClient, &ApiClient::libraryReceived, &libraryModel, &LibraryModel::setItems);
+    QObject::connect(&apiClient, &ApiClient::libraryStreamStarted, &libraryModel, &LibraryModel::beginLibraryStream);
+    QObject::connect(&apiClient, &ApiClient::libraryItemsReceived, &libraryModel, &LibraryModel::appendLibraryItems);
+    QObject::connect(&apiClient, &ApiClient::libraryStreamAborted, &libraryModel, &LibraryModel::abortLibraryStream);
+    QObject::connect(&apiClient, &ApiClient::libraryReceived, &libraryModel, &LibraryModel::finishLibraryStream);
+    QObject::connect(&apiClient, &ApiClient::libraryDeltaReceived, &libraryModel, &LibraryModel::applyDelta);
+    QObject::connect(&apiClient, &ApiClient::libraryReplaced, &libraryModel, &LibraryModel::replaceLibrary);
 
     playerController.setApiClient(&apiClient);
 
@@ -198,15 +185,18 @@ int main(int argc, char *argv[]) {
     QObject::connect(&engine, &QQmlApplicationEngine::warnings, &app,
                      [](const QList<QQmlError> &warnings) {
                          for (const auto &warning : warnings) {
-                             qWarning().noquote() << "QML warning:" << warning.toString();
+                             qCWarning(lcApp).noquote() << "QML warning:" << warning.toString();
                          }
                      });
     engine.rootContext()->setContextProperty("apiClient", &apiClient);
     engine.rootContext()->setContextProperty("controlPlaneClient", &controlPlaneClient);
     engine.rootContext()->setContextProperty("libraryModel", &libraryModel);
+    engine.rootContext()->setContextProperty("networkMetrics", httpCore.metrics());
     engine.rootContext()->setContextProperty("playerController", &playerController);
+    engine.rootContext()->setContextProperty("prefetchService", &prefetchService);
     engine.rootContext()->setContextProperty("serverDiscovery", &serverDiscovery);
     engine.rootContext()->setContextProperty("sessionManager", &sessionManager);
+    engine.rootContext()->setContextProperty("traceRecorder", TraceRecorder::instance());
 
     const QUrl url(QStringLiteral("qrc:/qml/main.qml"));
     QObject::connect(
@@ -221,5 +211,11 @@ int main(int argc, char *argv[]) {
         Qt::QueuedConnection);
     engine.load(url);
 
-    return app.exec();
+    const int exitCode = app.exec();
+    if (TraceRecorder::isEnabled()) {
+        const QString tracePath = TraceRecorder::instance()->write();
+        qCInfo(lcApp) << "Trace written" << tracePath;
+    }
+    AsyncLogger::shutdown();
+    return exitCode;
 }
@@ -15,6 +15,9 @@ Item {
     property string cardType: "portrait" // "portrait" | "landscape"
     property string badgeText: "" // e.g. "Unplayed" or count
     property string mediaId: ""
+    property string mediaType: ""
+    property string backdropSource: ""
+    readonly property bool prefetchIntent: hoverHandler.hovered || activeFocus
     
     signal clicked(string mediaId)
 
@@ -31,6 +34,32 @@ Item {
         onTapped: root.clicked(root.mediaId)
     }
 
+    onPrefetchIntentChanged: {
+        if (prefetchIntent) {
+            prefetchService.hoverStarted(mediaId, mediaType)
+        } else {
+            prefetchService.hoverEnded(mediaId)
+        }
+    }
+    Component.onDestruction: prefetchService.hoverEnded(mediaId)
+
+    // Loads the details backdrop into the pixmap cache once a prefetch starts.
+    Image {
+        id: backdropWarmup
+        visible: false
+        asynchronous: true
+    }
+
+    Connections {
+        target: prefetchService
+        enabled: root.prefetchIntent
+        function onActiveMediaIdChanged() {
+            if (prefetchService.activeMediaId === root.mediaId && root.backdropSource !== "") {
+                backdropWarmup.source = root.backdropSource
+            }
+        }
+    }
+
     // Scale Effect on Focus/Hover
     scale: hoverHandler.hovered ? 1.05 : 1.0
     Behavior on scale { NumberAnimation { duration: 150 } }
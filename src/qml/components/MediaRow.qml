@@ -12,6 +12,21 @@ Item {
 
     implicitHeight: column.implicitHeight
 
+    // Rows can be created hidden (e.g. while searching); prefetch once shown.
+    onVisibleChanged: {
+        if (!visible) {
+            return
+        }
+        var ids = []
+        for (var i = 0; i < view.contentItem.children.length; ++i) {
+            var card = view.contentItem.children[i]
+            if (card.mediaId) {
+                ids.push(card.mediaId)
+            }
+        }
+        apiClient.prefetchMediaDetails(ids)
+    }
+
     ColumnLayout {
         id: column
         width: parent.width
@@ -45,6 +60,8 @@ Item {
 
             delegate: MediaCard {
                 mediaId: model.mediaId
+                mediaType: model.type
+                backdropSource: model.backdrop
                 title: model.title
                 subtitle: model.year ? model.year : "" // Fallback logic
                 imageSource: model.poster // Assuming model has poster, might need backdrop for landscape
@@ -57,6 +74,9 @@ Item {
                     if (root.cardType === "landscape" && model.backdrop) {
                         imageSource = model.backdrop
                     }
+                    if (root.visible) {
+                        apiClient.prefetchMediaDetails([mediaId])
+                    }
                 }
             }
         }
@@ -37,6 +37,8 @@ Item {
 
             delegate: MediaCard {
                 mediaId: model.mediaId
+                mediaType: model.type
+                backdropSource: model.backdrop
                 title: model.title
                 imageSource: model.poster
                 progress: model.progress
@@ -94,7 +94,9 @@ ApplicationWindow {
                 id: stackView
                 Layout.fillWidth: true
                 Layout.fillHeight: true
-                initialItem: ConnectServerView { stackView: stackView; notice: root.authNotice }
+                // With a signed-in session and a library snapshot, start on
+                // the home screen and let it sync in the background.
+                initialItem: apiClient.authToken !== "" && libraryModel.count > 0 ? homeViewComponent : connectViewComponent
                 
                 // Add background for stackview area
                 background: Rectangle {
@@ -104,6 +106,16 @@ ApplicationWindow {
         }
     }
 
+    Component {
+        id: homeViewComponent
+        HomeView { stackView: stackView }
+    }
+
+    Component {
+        id: connectViewComponent
+        ConnectServerView { stackView: stackView; notice: root.authNotice }
+    }
+
     Connections {
         target: apiClient
         function onPlaybackStarted(info) {
@@ -22,9 +22,10 @@ Item {
     property string activeSeasonId: ""
     property var activeSeasonDetail: null
     property string seasonStatusText: ""
+    property var pendingRequests: ({})
     property var libraryItem: {
-        var idx = libraryModel.indexOfId(mediaId)
-        return idx >= 0 ? libraryModel.get(idx) : null
+        var item = libraryModel.itemById(mediaId)
+        return item.valid ? item : null
     }
 
     function refreshReviewQueue() {
@@ -222,8 +223,8 @@ Item {
         activeSeasonDetail = null
         episodes = []
         seasonStatusText = ""
-        apiClient.fetchSeasonDetail(seasonId)
-        apiClient.fetchEpisodes(seasonId)
+        pendingRequests.seasonDetail = apiClient.fetchSeasonDetail(seasonId)
+        pendingRequests.episodes = apiClient.fetchEpisodes(seasonId)
     }
 
     function selectDefaultSeason() {
@@ -246,18 +247,40 @@ Item {
     }
 
     Component.onCompleted: {
+        apiClient.warmConnection()
         if (mediaId !== "") {
-            apiClient.fetchMediaDetails(mediaId)
+            loadDetails()
             refreshReviewQueue()
         }
     }
 
+    Component.onDestruction: {
+        for (var kind in pendingRequests) {
+            apiClient.cancelRequest(pendingRequests[kind])
+        }
+    }
+
     onMediaIdChanged: {
         if (mediaId !== "") {
-            apiClient.fetchMediaDetails(mediaId)
-            refreshReviewQueue()
             resetSeasonState()
+            loadDetails()
+            refreshReviewQueue()
+        }
+    }
+
+    function loadDetails() {
+        var cached = apiClient.cachedMediaDetails(mediaId)
+        if (cached.id !== mediaId) {
+            pendingRequests.details = apiClient.fetchMediaDetails(mediaId)
+            return
+        }
+        details = cached
+        statusText = ""
+        if (isSeriesType()) {
+            pendingRequests.seasons = apiClient.fetchSeasons(mediaId)
         }
+        // The cached copy may be minutes old; check it behind what is shown.
+        pendingRequests.details = apiClient.refreshMediaDetails(mediaId)
     }
 
     Flickable {
@@ -452,7 +475,7 @@ Item {
 
                     Button {
                         text: "Retry"
-                        onClicked: apiClient.fetchMediaDetails(mediaId)
+                        onClicked: pendingRequests.details = apiClient.fetchMediaDetails(mediaId)
                         background: Rectangle {
                             radius: Theme.radiusSmall
                             color: Theme.backgroundCardRaised
@@ -1019,7 +1042,7 @@ Item {
                 statusText = ""
                 refreshReviewQueue()
                 if (isSeriesType()) {
-                    apiClient.fetchSeasons(obj.id)
+                    pendingRequests.seasons = apiClient.fetchSeasons(obj.id)
                 } else {
                     resetSeasonState()
                 }
@@ -1053,7 +1076,7 @@ Item {
         function onReviewApplied(reviewId) {
             if (reviewId === activeReviewId) {
                 reviewStatusText = "Match applied."
-                apiClient.fetchMediaDetails(mediaId)
+                pendingRequests.details = apiClient.fetchMediaDetails(mediaId)
                 refreshReviewQueue()
             }
         }
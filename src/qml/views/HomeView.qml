@@ -21,7 +21,7 @@ Item {
         isLoading = true
         statusText = "Loading library..."
         statusIsError = false
-        apiClient.fetchLibrary()
+        apiClient.syncLibrary(libraryModel.syncCursor)
     }
 
     Flickable {
@@ -67,8 +67,8 @@ Item {
             PosterGrid {
                 Layout.fillWidth: true
                 title: "Search Results"
-                visible: root.searchActive && libraryModel.searchModel.count > 0
-                model: libraryModel.searchModel
+                visible: root.searchActive && libraryModel.rankedSearchModel.count > 0
+                model: libraryModel.rankedSearchModel
                 onCardClicked: {
                     if (root.stackView) {
                         root.stackView.push(Qt.resolvedUrl("DetailsView.qml"), { mediaId: mediaId, stackView: root.stackView })
@@ -83,7 +83,7 @@ Item {
                 Layout.margins: Theme.cardSpacing
                 radius: Theme.radiusLarge
                 color: Theme.bgCard
-                visible: root.searchActive && libraryModel.searchModel.count === 0
+                visible: root.searchActive && libraryModel.rankedSearchModel.count === 0
 
                 ColumnLayout {
                     anchors.centerIn: parent
@@ -221,9 +221,14 @@ Item {
             statusText = "Scan completed. Refreshing..."
             isLoading = true
             statusIsError = false
-            apiClient.fetchLibrary()
+            apiClient.syncLibrary(libraryModel.syncCursor)
         }
-        function onLibraryReceived(items) {
+        function onLibraryReceived() {
+            statusText = ""
+            statusIsError = false
+            isLoading = false
+        }
+        function onLibraryDeltaReceived(items, removedIds) {
             statusText = ""
             statusIsError = false
             isLoading = false
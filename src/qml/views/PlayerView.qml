@@ -763,6 +763,7 @@ Item {
         applyHeaders()
         if (playerController.streamUrl !== "") {
             console.log("PlayerView ready", playerController.streamUrl, playerController.mode)
+            traceRecorder.instant("mpv loadfile", "player")
             mpv.commandAsync(["loadfile", playerController.streamUrl, "replace"])
             mpv.setPropertyAsync("pause", false)
             resetTrackState()
@@ -795,6 +796,7 @@ Item {
             console.log("Stream URL changed", playerController.streamUrl, playerController.mode)
             resetTrackState()
             mpv.commandAsync(["stop"])
+            traceRecorder.instant("mpv loadfile", "player")
             mpv.commandAsync(["loadfile", playerController.streamUrl, "replace"])
             mpv.setPropertyAsync("pause", false)
             trackRefreshTimer.restart()
@@ -385,6 +385,143 @@ Item {
                     onEditingFinished: sessionManager.playbackSupportedAudioCodecs = parseList(text)
                 }
 
+                Rectangle {
+                    height: 1
+                    color: Theme.border
+                    Layout.fillWidth: true
+                }
+
+                Label {
+                    text: "Network metrics"
+                    color: Theme.textPrimary
+                    font.pixelSize: 16
+                    font.family: Theme.fontDisplay
+                }
+
+                Repeater {
+                    model: networkMetrics.endpoints
+                    delegate: Label {
+                        Layout.fillWidth: true
+                        text: modelData.endpoint + (modelData.route !== "" ? " (" + modelData.route + ")" : "")
+                              + "  ·  " + modelData.requests + " req, " + modelData.errors + " err"
+                              + "  ·  p50 " + modelData.totalP50 + " ms, p99 " + modelData.totalP99 + " ms"
+                              + "  ·  ttfb " + modelData.ttfbP50 + " ms, parse " + modelData.parseP50 + " ms"
+                        color: modelData.errors > 0 ? Theme.textSecondary : Theme.textMuted
+                        font.pixelSize: 11
+                        font.family: Theme.fontBody
+                        elide: Text.ElideRight
+                    }
+                }
+
+                Label {
+                    text: "No requests recorded yet."
+                    color: Theme.textMuted
+                    font.pixelSize: 11
+                    font.family: Theme.fontBody
+                    visible: networkMetrics.endpoints.length === 0
+                }
+
+                Label {
+                    text: "Write metrics to " + networkMetrics.dumpDirectory
+                    color: Theme.textSecondary
+                    font.pixelSize: 12
+                    font.family: Theme.fontBody
+                }
+
+                RowLayout {
+                    spacing: Theme.spacingSmall
+
+                    ComboBox {
+                        property var intervals: [0, 60, 300]
+                        model: ["Off", "Every minute", "Every 5 minutes"]
+                        currentIndex: Math.max(0, intervals.indexOf(networkMetrics.dumpIntervalSeconds))
+                        onActivated: networkMetrics.dumpIntervalSeconds = intervals[index]
+                    }
+
+                    Button {
+                        text: "Write now"
+                        onClicked: networkMetrics.dumpNow()
+                        background: Rectangle {
+                            radius: Theme.radiusSmall
+                            color: Theme.backgroundCardRaised
+                            border.color: Theme.border
+                        }
+                        contentItem: Label {
+                            text: parent.text
+                            color: Theme.textPrimary
+                            font.pixelSize: 12
+                            font.family: Theme.fontBody
+                            horizontalAlignment: Text.AlignHCenter
+                            verticalAlignment: Text.AlignVCenter
+                        }
+                    }
+
+                    Button {
+                        text: "Reset"
+                        onClicked: networkMetrics.reset()
+                        background: Rectangle {
+                            radius: Theme.radiusSmall
+                            color: Theme.backgroundCardRaised
+                            border.color: Theme.border
+                        }
+                        contentItem: Label {
+                            text: parent.text
+                            color: Theme.textPrimary
+                            font.pixelSize: 12
+                            font.family: Theme.fontBody
+                            horizontalAlignment: Text.AlignHCenter
+                            verticalAlignment: Text.AlignVCenter
+                        }
+                    }
+                }
+
+                Label {
+                    text: "Tracing"
+                    color: Theme.textPrimary
+                    font.pixelSize: 16
+                    font.family: Theme.fontDisplay
+                }
+
+                RowLayout {
+                    spacing: Theme.spacingSmall
+
+                    Button {
+                        text: traceRecorder.enabled ? "Stop and save trace" : "Start trace"
+                        onClicked: {
+                            if (traceRecorder.enabled) {
+                                traceRecorder.enabled = false
+                                traceRecorder.write()
+                            } else {
+                                traceRecorder.enabled = true
+                            }
+                        }
+                        background: Rectangle {
+                            radius: Theme.radiusSmall
+                            color: Theme.backgroundCardRaised
+                            border.color: Theme.border
+                        }
+                        contentItem: Label {
+                            text: parent.text
+                            color: Theme.textPrimary
+                            font.pixelSize: 12
+                            font.family: Theme.fontBody
+                            horizontalAlignment: Text.AlignHCenter
+                            verticalAlignment: Text.AlignVCenter
+                        }
+                    }
+
+                    Label {
+                        Layout.fillWidth: true
+                        text: traceRecorder.lastTracePath !== ""
+                              ? "Saved " + traceRecorder.lastTracePath
+                              : "Open saved traces in ui.perfetto.dev"
+                        color: Theme.textSecondary
+                        font.pixelSize: 12
+                        font.family: Theme.fontBody
+                        elide: Text.ElideMiddle
+                    }
+                }
+
                 RowLayout {
                     spacing: Theme.spacingMedium
 